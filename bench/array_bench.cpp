@@ -0,0 +1,100 @@
+#include <algorithm>
+#include <chrono>
+#include <print>
+#include <vector>
+#include "lang_runtime.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+template<typename F>
+auto median_nanoseconds(size_t repetitions, F function) -> double {
+    std::vector<double> samples;
+
+    for (size_t idx = 0; idx < repetitions; ++idx) {
+        auto start = Clock::now();
+        function();
+        std::chrono::duration<double, std::nano> elapsed =
+            Clock::now() - start;
+        samples.push_back(elapsed.count());
+    }
+
+    std::ranges::sort(samples);
+    return samples[samples.size() / 2];
+}
+
+// Appends length numbers to an empty array through the runtime entry point
+// used by the generated code.
+auto fill(lib::Runtime& runtime, int64_t length) -> lib::Array* {
+    auto* array = lib::Runtime::allocate_array(
+        &runtime,
+        {Type::Number, 1},
+        0,
+        nullptr
+    );
+
+    for (int64_t idx = 0; idx < length; ++idx) {
+        lib::Runtime::append_element(
+            array,
+            std::bit_cast<uint64_t>(static_cast<double>(idx))
+        );
+    }
+
+    return array;
+}
+
+void run_benchmark(int64_t length) {
+    size_t repetitions = std::max<size_t>(5, 100000000 / length);
+    double sink = 0;
+
+    double append = median_nanoseconds(repetitions, [&] {
+        lib::Runtime runtime;
+        fill(runtime, length);
+        lib::Runtime::post_exec_cleanup(&runtime);
+    });
+
+    lib::Runtime runtime;
+    lib::Array* array = fill(runtime, length);
+
+    double call = median_nanoseconds(repetitions, [&] {
+        for (int64_t idx = 0; idx < length; ++idx) {
+            sink += std::bit_cast<double>(
+                lib::Runtime::array_element(&runtime, array, idx)
+            );
+        }
+    });
+
+    // The same bounds check and load the JIT emits for inline access.
+    double direct = median_nanoseconds(repetitions, [&] {
+        for (int64_t idx = 0; idx < length; ++idx) {
+            if (idx < array->length) {
+                sink += array->items<double>()[idx];
+            }
+        }
+    });
+
+    lib::Runtime::post_exec_cleanup(&runtime);
+
+    std::println(
+        "{:>10} {:>12.2f} {:>12.2f} {:>12.2f} {:>8}",
+        length,
+        append / length,
+        call / length,
+        direct / length,
+        sink != 0
+    );
+}
+
+auto main() -> int {
+    std::println(
+        "{:>10} {:>12} {:>12} {:>12} {:>8}",
+        "length",
+        "append(ns)",
+        "element(ns)",
+        "inline(ns)",
+        "checked"
+    );
+
+    for (int64_t length : {16, 1024, 65536, 1048576}) {
+        run_benchmark(length);
+    }
+}
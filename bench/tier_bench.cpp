@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <print>
+#include <sstream>
+#include "checker.hpp"
+#include "codegen.hpp"
+#include "dependency.hpp"
+#include "driver.hpp"
+#include "fold.hpp"
+#include "interpreter.hpp"
+#include "liveness.hpp"
+#include "optimize.hpp"
+#include "promote.hpp"
+#include "value_numbering.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+auto generate_module(size_t statement_count, bool numeric) -> std::string {
+    std::string source = "v0 = 1.5;\ns0 = \"a\";\nb0 = true;\n";
+    size_t group_size = numeric ? 1 : 3;
+
+    for (size_t idx = 1; idx < statement_count / group_size; ++idx) {
+        size_t prev = idx - 1;
+        source += std::format(
+            "v{} = v{} * 1.0001 + {} - v{} / 3;\n",
+            idx,
+            prev,
+            idx,
+            prev
+        );
+
+        if (numeric) {
+            continue;
+        }
+
+        source += std::format(
+            "s{} = b{} ? s{} + \"x\" : \"\" + v{};\n",
+            idx,
+            prev,
+            prev,
+            idx
+        );
+        source += std::format(
+            "b{} = v{} > v{} && s{} != s{} || !b{};\n",
+            idx,
+            idx,
+            prev,
+            idx,
+            prev,
+            prev
+        );
+    }
+
+    return source;
+}
+
+auto compile(std::string const& source, OptimizationFlags optimization)
+    -> std::unique_ptr<Program> {
+    std::istringstream input(source);
+    Driver driver;
+    driver.parse(input);
+
+    dgeval::ast::Dependency dependency;
+    driver.program->accept(dependency);
+    dgeval::ast::Checker checker;
+    driver.program->accept(checker);
+    dgeval::ast::Fold folder(optimization);
+    driver.program->accept(folder);
+    dgeval::ast::Liveness liveness(optimization);
+    driver.program->accept(liveness);
+    dgeval::ast::Promotion promotion(optimization);
+    driver.program->accept(promotion);
+    dgeval::ast::GraphBuilder builder(optimization);
+    driver.program->accept(builder);
+    dgeval::ast::ValueNumbering numbering;
+    numbering.run(*driver.program);
+    dgeval::ast::StackLowering lowering(optimization);
+    lowering.run(*driver.program);
+    dgeval::ast::Peephole peephole(driver.program->instructions, optimization);
+    peephole.run();
+    dgeval::ast::check_stack_depth(*driver.program);
+
+    return std::move(driver.program);
+}
+
+template<typename F>
+auto median_microseconds(size_t repetitions, F function) -> double {
+    std::vector<double> samples;
+
+    for (size_t idx = 0; idx < repetitions; ++idx) {
+        auto start = Clock::now();
+        function();
+        std::chrono::duration<double, std::micro> elapsed =
+            Clock::now() - start;
+        samples.push_back(elapsed.count());
+    }
+
+    std::ranges::sort(samples);
+    return samples[samples.size() / 2];
+}
+
+void run_benchmark(
+    size_t statements,
+    bool numeric,
+    OptimizationFlags optimization
+) {
+    auto program =
+        compile(generate_module(statements, numeric), optimization);
+    size_t repetitions = std::max<size_t>(5, 30000 / statements);
+
+    double interpreted = median_microseconds(repetitions, [&] {
+        Interpreter interpreter(*program);
+        lib::Runtime runtime;
+        interpreter.run(&runtime);
+    });
+
+    double compiled = median_microseconds(repetitions, [&] {
+        Codegen codegen(optimization);
+        DynamicFunction* func = codegen.generate(*program);
+        lib::Runtime runtime;
+        runtime.literals = codegen.module.literals.data();
+        func(&runtime);
+    });
+
+    std::println(
+        "{:>8} {:>10} {:>12} {:>14.1f} {:>14.1f} {:>10}",
+        numeric ? "numeric" : "mixed",
+        statements,
+        program->instructions.size(),
+        interpreted,
+        compiled,
+        interpreted <= compiled ? "interpret" : "jit"
+    );
+}
+
+auto main() -> int {
+    OptimizationFlags optimization;
+
+    std::println(
+        "{:>8} {:>10} {:>12} {:>14} {:>14} {:>10}",
+        "corpus",
+        "statements",
+        "instructions",
+        "interpret(us)",
+        "jit(us)",
+        "faster"
+    );
+
+    for (bool numeric : {false, true}) {
+        for (size_t statements : {3, 30, 300, 3000, 30000, 100000}) {
+            run_benchmark(statements, numeric, optimization);
+        }
+    }
+}
+
@@ -0,0 +1,63 @@
+#include "arena.hpp"
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+
+CodeArena::CodeArena() {
+    size_t page_size = getpagesize();
+    void* p = mmap(
+        nullptr,
+        page_size,
+        PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS,
+        -1,
+        0
+    );
+
+    if (p != MAP_FAILED) {
+        base = static_cast<uint8_t*>(p);
+        capacity = page_size;
+    }
+}
+
+CodeArena::~CodeArena() {
+    if (base) {
+        munmap(base, capacity);
+    }
+}
+
+auto CodeArena::reserve(size_t size) -> bool {
+    if (size <= capacity) {
+        return true;
+    }
+
+    if (!base || sealed) {
+        return false;
+    }
+
+    size_t page_size = getpagesize();
+    size_t new_capacity = std::max(
+        capacity * 2,
+        (size + page_size - 1) / page_size * page_size
+    );
+    void* p = mremap(base, capacity, new_capacity, MREMAP_MAYMOVE);
+
+    if (p == MAP_FAILED) {
+        return false;
+    }
+
+    base = static_cast<uint8_t*>(p);
+    capacity = new_capacity;
+
+    return true;
+}
+
+auto CodeArena::seal() -> void* {
+    if (!base || (!sealed && mprotect(base, capacity, PROT_READ | PROT_EXEC))) {
+        return nullptr;
+    }
+
+    sealed = true;
+
+    return base;
+}
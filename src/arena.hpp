@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+class CodeArena {
+  public:
+    CodeArena();
+    CodeArena(CodeArena const&) = delete;
+    auto operator=(CodeArena const&) -> CodeArena& = delete;
+    ~CodeArena();
+
+    auto reserve(size_t size) -> bool;
+    auto seal() -> void*;
+
+    uint8_t* base {nullptr};
+    size_t capacity {0};
+    bool sealed {false};
+};
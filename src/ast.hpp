@@ -39,13 +39,34 @@ enum class Opcode : std::uint8_t {
     Literal = 25,
     CallLRT = 26,
     Pop = 27,
+    JumpEqual = 28,
+    JumpNotEqual = 29,
+    JumpLess = 30,
+    JumpLessEqual = 31,
+    JumpGreater = 32,
+    JumpGreaterEqual = 33,
+    Phi = 34,
+    // Typed forms chosen by LinearIR and GraphBuilder; the AST never uses
+    // them.
+    ArrayElement = 35,
+    Append = 36,
+    Concat = 37,
+    NumberToString = 38,
+    CompareString = 39,
+    CompareArray = 40,
+    EqualBoolean = 41,
+    NotEqualBoolean = 42,
+    JumpEqualBoolean = 43,
+    JumpNotEqualBoolean = 44,
 };
 
-const std::array<std::string, 28> MNEMONICS = {
-    "nop", "comma", "assign", "cond",  "alt",   "band", "bor",
-    "eq",  "neq",   "lt",     "lte",   "gt",    "gte",  "add",
-    "sub", "mul",   "div",    "minus", "not",   "aa",   "call",
-    "jmp", "jf",    "jt",     "id",    "const", "lrt",  "pop"
+const std::array<std::string, 45> MNEMONICS = {
+    "nop",  "comma", "assign", "cond",  "alt",   "band", "bor",  "eq",
+    "neq",  "lt",    "lte",    "gt",    "gte",   "add",  "sub",  "mul",
+    "div",  "minus", "not",    "aa",    "call",  "jmp",  "jf",   "jt",
+    "id",   "const", "lrt",    "pop",   "jeq",   "jneq", "jlt",  "jlte",
+    "jgt",  "jgte",  "phi",    "elem",  "app",   "cat",  "ntos", "scmp",
+    "acmp", "beq",   "bneq",   "jbeq",  "jbneq"
 };
 
 const std::array<std::string, 21> OPERATOR_SYMBOLS = {
@@ -103,6 +124,7 @@ class FunctionSignature {
     TypeDescriptor return_type;
     size_t parameter_count;
     std::vector<TypeDescriptor> parameters;
+    bool pure {true};
 };
 
 const std::map<std::string, FunctionSignature> RUNTIME_LIBRARY = {
@@ -120,8 +142,8 @@ const std::map<std::string, FunctionSignature> RUNTIME_LIBRARY = {
     {"acos", {(void*)lib::acos, 11, NUMBER, 1, {NUMBER}}},
     {"exp", {(void*)lib::exp, 12, NUMBER, 1, {NUMBER}}},
     {"ln", {(void*)lib::ln, 13, NUMBER, 1, {NUMBER}}},
-    {"print", {(void*)lib::print, 14, NUMBER, 1, {STRING}}},
-    {"random", {(void*)lib::random, 15, NUMBER, 1, {NUMBER}}},
+    {"print", {(void*)lib::print, 14, NUMBER, 1, {STRING}, false}},
+    {"random", {(void*)lib::random, 15, NUMBER, 1, {NUMBER}, false}},
     {"len", {(void*)lib::len, 16, NUMBER, 1, {STRING}}},
     {"right", {(void*)lib::right, 17, STRING, 2, {STRING, NUMBER}}},
     {"left", {(void*)lib::left, 18, STRING, 2, {STRING, NUMBER}}},
@@ -130,6 +152,7 @@ const std::map<std::string, FunctionSignature> RUNTIME_LIBRARY = {
 struct SymbolDescriptor {
     TypeDescriptor type_desc;
     int idx {-1};
+    int home {-1};
 };
 
 class Expression {
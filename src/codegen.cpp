@@ -1,8 +1,6 @@
 #include "codegen.hpp"
-#include <sys/mman.h>
-#include <unistd.h>
-#include <cstdlib>
 #include <cstring>
+#include <unordered_set>
 #include <variant>
 #include "ast.hpp"
 #include "linear_ir.hpp"
@@ -11,9 +9,13 @@
 std::array<Register, 4> Codegen::registers =
     {Register::RDI, Register::RSI, Register::RDX, Register::RCX};
 
-Codegen::~Codegen() {
-    free(code_base);
-}
+std::array<Register, PROMOTION_REGISTER_COUNT> Codegen::promotion_registers =
+    {Register::RBX, Register::R12, Register::R13, Register::R14};
+
+Codegen::Codegen(OptimizationFlags flags) :
+    register_stack(flags[Optimization::RegisterStack]),
+    inline_array_access(flags[Optimization::InlineArrayAccess]),
+    constant_operands(flags[Optimization::ConstantOperands]) {}
 
 void Codegen::emit_bytes(std::initializer_list<uint8_t> bytes) {
     for (auto byte : bytes) {
@@ -25,37 +27,17 @@ template<typename T>
 void Codegen::emit_code_fragment(T code_fragment) {
     size_t fragment_size = sizeof(code_fragment);
 
-    if (code_len + fragment_size >= bag_size) {
-        size_t new_size = bag_size + DELTA + fragment_size;
-        auto* new_base = std::bit_cast<uint8_t*>(realloc(code_base, new_size));
-
-        if (new_base) {
-            code_base = new_base;
-            bag_size = new_size;
-        }
-    }
-
-    if (code_len < bag_size) {
-        *std::bit_cast<T*>(code_base + code_len) = code_fragment;
+    if (arena.reserve(code_len + fragment_size)) {
+        std::memcpy(arena.base + code_len, &code_fragment, fragment_size);
         code_len += fragment_size;
+    } else {
+        truncated = true;
     }
 }
 
-auto Codegen::create_code_base() const -> void* {
-    int page_size = getpagesize();
-    size_t page_count = (code_len + page_size - 1) / page_size;
-    size_t alloc_size = page_size * page_count;
-
-    void* p = aligned_alloc(page_size, alloc_size);
-
-    memmove(p, code_base, code_len);
-    mprotect(p, alloc_size, PROT_EXEC);
-
-    return p;
-}
-
 void Codegen::emit_prologue(int variable_count) {
-    int variable_area = variable_count << 3;
+    int padding = (variable_count + saved_registers.size()) % 2;
+    int variable_area = (variable_count + padding) << 3;
 
     // emit_bytes({0xc8});
     // emit_code_fragment((uint16_t)variable_area);
@@ -64,21 +46,46 @@ void Codegen::emit_prologue(int variable_count) {
     emit_bytes({0x55, 0x48, 0x89, 0xe5, 0x48, 0x81, 0xec});
     emit_code_fragment(variable_area);
 
-    emit_bytes({0x41, 0x54});
+    for (auto reg : saved_registers) {
+        push_register(reg);
+    }
+
+    uint8_t runtime_reg = std::to_underlying(RUNTIME_REGISTER) & 0b111;
+    emit_bytes({0x49, 0x89, modrm(0b11, 7, runtime_reg)});
+
+    frame_size = variable_area + 8 * saved_registers.size();
 }
 
 void Codegen::emit_epilogue() {
-    // emit_bytes({0x41, 0x5c, 0xc9, 0xc3});
+    // emit_bytes({0xc9, 0xc3});
+
+    size_t restore_location = code_len;
 
-    emit_bytes({0x41, 0x5c, 0x48, 0x89, 0xec, 0x5d, 0xc3});
+    emit_bytes({0x48, 0x8d, 0xa5});
+    emit_code_fragment(-frame_size);
+
+    for (auto reg = saved_registers.rbegin(); reg != saved_registers.rend();
+         ++reg) {
+        pop_register(*reg);
+    }
+
+    emit_bytes({0x48, 0x89, 0xec, 0x5d, 0xc3});
 
     unwind_location = code_len;
-    setup_immediate_integral_arg(0, std::bit_cast<uint64_t>(&runtime));
+    emit_bytes({0x48, 0x8d, 0xa5});
+    emit_code_fragment(-frame_size);
+    stack_depth = 0;
+    setup_runtime_arg(0);
     emit_call(reinterpret_cast<void*>(lib::Runtime::post_exec_cleanup));
-    emit_bytes({0x48, 0x89, 0xec, 0x5d, 0xc3});
+    emit_bytes({0xe9});
+    emit_code_fragment(static_cast<uint32_t>(restore_location - code_len - 4));
+
+    if (truncated) {
+        return;
+    }
 
     for (auto f : unwind_fixups) {
-        *std::bit_cast<uint32_t*>(code_base + f) = unwind_location - f - 4;
+        *std::bit_cast<uint32_t*>(arena.base + f) = unwind_location - f - 4;
     }
 }
 
@@ -100,72 +107,174 @@ void Codegen::xmm_arith_instruction(uint8_t critical_byte) {
     emit_bytes({0x48, 0x83, 0xC4, 0x08, 0xF2, 0x0F, 0x11, 0x04, 0x24});
 }
 
-void Codegen::comparison_instruction(
-    TypeDescriptor type_desc,
-    uint8_t critical_byte
-) {
-    if (type_desc.is_array()) {
-        setup_argument(1, false);
-        setup_argument(0, false);
-        emit_call(reinterpret_cast<void*>(lib::Runtime::arrcmp));
-        emit_bytes({0x48, 0x31, 0xc9});
-        emit_bytes({0x48, 0x83, 0xf8, 0x00});
-    } else {
-        switch (type_desc.type) {
-            case Type::Number:
-                emit_bytes({0x48, 0x31, 0xc9});
-                emit_bytes(
-                    {0x48,
-                     0x83,
-                     0xC4,
-                     0x10,
-                     0xF2,
-                     0x0F,
-                     0x10,
-                     0x44,
-                     0x24,
-                     0xF8,
-                     0x66,
-                     0x0F,
-                     0x2F,
-                     0x44,
-                     0x24,
-                     0xF0}
-                );
+void Codegen::comparison_instruction(bool number, uint8_t critical_byte) {
+    emit_bytes({0x48, 0x31, 0xc9});
 
-                if (critical_byte > 0x78) {
-                    critical_byte = ((critical_byte << 1) & 0b100) | 0b10
-                        | (critical_byte & static_cast<uint8_t>(0xf1));
-                }
-                break;
-            case Type::Boolean:
-                emit_bytes({0x48, 0x31, 0xc9});
-                emit_bytes({0x5f, 0x58, 0x48, 0x39, 0xf8});
-                break;
-            case Type::String:
-                setup_argument(1, false);
-                setup_argument(0, false);
-                emit_call(reinterpret_cast<void*>(lib::Runtime::strcmp));
-                emit_bytes({0x48, 0x31, 0xc9});
-                emit_bytes({0x48, 0x83, 0xf8, 0x00});
-            default:
-                break;
-        }
+    if (number) {
+        emit_bytes(
+            {0x48,
+             0x83,
+             0xC4,
+             0x10,
+             0xF2,
+             0x0F,
+             0x10,
+             0x44,
+             0x24,
+             0xF8,
+             0x66,
+             0x0F,
+             0x2F,
+             0x44,
+             0x24,
+             0xF0}
+        );
+
+        critical_byte = unsigned_condition(critical_byte);
+    } else {
+        emit_bytes({0x5f, 0x58, 0x48, 0x39, 0xf8});
     }
 
     emit_bytes({critical_byte, 0x03, 0x48, 0xff, 0xc1, 0x51});
 }
 
+void Codegen::conditional_jump(uint8_t condition, int target) {
+    jump_fixups.emplace_back(code_len + 2, target);
+    emit_bytes({0x0f, static_cast<uint8_t>(0x80 | (condition & 0x0f))});
+    emit_code_fragment(static_cast<uint32_t>(0));
+}
+
+void Codegen::branch_instruction(Instruction& instruction) {
+    if (instruction.opcode == Opcode::JumpEqualBoolean
+        || instruction.opcode == Opcode::JumpNotEqualBoolean) {
+        Opcode relation = instruction.opcode == Opcode::JumpEqualBoolean
+            ? Opcode::JumpEqual
+            : Opcode::JumpNotEqual;
+
+        emit_bytes({0x5f, 0x58, 0x48, 0x39, 0xf8});
+        conditional_jump(branch_condition(relation), instruction.parameter);
+        return;
+    }
+
+    uint8_t condition = branch_condition(instruction.opcode);
+
+    emit_bytes(
+        {0x48,
+         0x83,
+         0xC4,
+         0x10,
+         0xF2,
+         0x0F,
+         0x10,
+         0x44,
+         0x24,
+         0xF8,
+         0x66,
+         0x0F,
+         0x2F,
+         0x44,
+         0x24,
+         0xF0}
+    );
+
+    conditional_jump(unsigned_condition(condition), instruction.parameter);
+}
+
 void Codegen::emit_call(void* call_address) {
+    bool sample = profile && profile_line != 0;
+
+    if (sample) {
+        emit_bytes({0x49, 0x89, 0xd3});
+        begin_profile_sample(offsetof(lib::Runtime, call_start));
+        emit_bytes({0x4c, 0x89, 0xda});
+    }
+
+    module.add_relocation(code_len + 2, symbol_name(call_address));
     emit_bytes({0x48, 0xb8});
     emit_code_fragment(call_address);
-    emit_bytes(
-        {0x49, 0x89, 0xE4, 0x48, 0x83, 0xE4, 0xF0, 0xFF, 0xD0, 0x4C, 0x89, 0xE4}
+
+    if (stack_depth % 2 != 0) {
+        emit_bytes({0x48, 0x83, 0xec, 0x08});
+        emit_bytes({0xff, 0xd0});
+        emit_bytes({0x48, 0x83, 0xc4, 0x08});
+    } else {
+        emit_bytes({0xff, 0xd0});
+    }
+
+    if (sample) {
+        emit_bytes({0x49, 0x89, 0xc3});
+        end_profile_sample(
+            offsetof(lib::Runtime, call_start),
+            profile_site(profile_line, symbol_name(call_address))
+        );
+        emit_bytes({0x4c, 0x89, 0xd8});
+    }
+}
+
+void Codegen::emit_timestamp() {
+    emit_bytes({0x0f, 0x31, 0x48, 0xc1, 0xe2, 0x20, 0x48, 0x09, 0xd0});
+}
+
+void Codegen::begin_profile_sample(size_t start_field) {
+    uint8_t runtime_reg = std::to_underlying(RUNTIME_REGISTER) & 0b111;
+
+    emit_timestamp();
+    emit_bytes({0x49, 0x89, modrm(0b10, 0, runtime_reg)});
+    emit_code_fragment(static_cast<uint32_t>(start_field));
+}
+
+void Codegen::end_profile_sample(size_t start_field, int site) {
+    uint8_t runtime_reg = std::to_underlying(RUNTIME_REGISTER) & 0b111;
+    auto counter = static_cast<uint32_t>(site * sizeof(lib::ProfileCounter));
+
+    emit_timestamp();
+    emit_bytes({0x49, 0x2b, modrm(0b10, 0, runtime_reg)});
+    emit_code_fragment(static_cast<uint32_t>(start_field));
+    emit_bytes({0x49, 0x8b, modrm(0b10, 2, runtime_reg)});
+    emit_code_fragment(
+        static_cast<uint32_t>(offsetof(lib::Runtime, profile))
+    );
+    emit_bytes({0x48, 0xff, modrm(0b10, 0, 2)});
+    emit_code_fragment(
+        counter + static_cast<uint32_t>(offsetof(lib::ProfileCounter, count))
+    );
+    emit_bytes({0x48, 0x01, modrm(0b10, 0, 2)});
+    emit_code_fragment(
+        counter + static_cast<uint32_t>(offsetof(lib::ProfileCounter, cycles))
     );
 }
 
+void Codegen::profile_statement(int line) {
+    if (profile_line != 0) {
+        end_profile_sample(
+            offsetof(lib::Runtime, statement_start),
+            profile_site(profile_line, "")
+        );
+    }
+
+    profile_line = line;
+
+    if (profile_line != 0) {
+        begin_profile_sample(offsetof(lib::Runtime, statement_start));
+    }
+}
+
+auto Codegen::profile_site(int line, std::string const& callee) -> int {
+    auto found = std::ranges::find_if(profile_sites, [&](auto const& site) {
+        return site.line == line && site.callee == callee;
+    });
+
+    if (found != profile_sites.end()) {
+        return static_cast<int>(found - profile_sites.begin());
+    }
+
+    profile_sites.push_back({line, callee});
+    return static_cast<int>(profile_sites.size() - 1);
+}
+
 void Codegen::setup_argument(int idx, bool is_double) {
     emit_bytes({0x58});
+    --stack_depth;
 
     if (is_double) {
         uint8_t critical_byte = 0xc0 + 8 * idx;
@@ -182,6 +291,12 @@ void Codegen::setup_immediate_integral_arg(int idx, uint64_t arg) {
     emit_code_fragment(arg);
 }
 
+void Codegen::setup_runtime_arg(int idx) {
+    uint8_t reg = std::to_underlying(registers[idx]);
+    uint8_t runtime_reg = std::to_underlying(RUNTIME_REGISTER) & 0b111;
+    emit_bytes({0x4c, 0x89, modrm(0b11, runtime_reg, reg)});
+}
+
 void Codegen::setup_immediate_double_arg(int idx, double arg) {
     uint8_t critical_byte = 0xc0 + 8 * std::to_underlying(registers[idx]);
     emit_bytes({0x48, 0xb8});
@@ -189,12 +304,412 @@ void Codegen::setup_immediate_double_arg(int idx, double arg) {
     emit_bytes({0x66, 0x48, 0x0f, 0x6e, critical_byte});
 }
 
+void Codegen::setup_constant_arg(
+    int idx,
+    uint8_t critical_byte,
+    int constant
+) {
+    uint8_t reg = std::to_underlying(registers[idx]);
+    emit_bytes({0x48, critical_byte, modrm(0, reg, 0b101)});
+    emit_constant(constant);
+}
+
+void Codegen::emit_constant(int constant) {
+    constant_fixups.emplace_back(code_len, constant);
+    emit_code_fragment(static_cast<uint32_t>(0));
+}
+
+void Codegen::emit_constant_pool() {
+    while (code_len % 16 != 0 && !truncated) {
+        emit_bytes({0xcc});
+    }
+
+    size_t pool_start = code_len;
+
+    if (!arena.reserve(code_len + pool.data.size())) {
+        truncated = true;
+        return;
+    }
+
+    std::memcpy(arena.base + code_len, pool.data.data(), pool.data.size());
+    code_len += pool.data.size();
+
+    for (auto [fixup, constant] : constant_fixups) {
+        *std::bit_cast<uint32_t*>(arena.base + fixup) =
+            pool_start + constant - fixup - 4;
+    }
+}
+
 void Codegen::place_result_on_stack(bool is_double) {
     if (is_double) {
         emit_bytes({0x66, 0x48, 0x0F, 0x7E, 0xC0});
     }
 
     emit_bytes({0x50});
+    ++stack_depth;
+}
+
+void Codegen::push_register(Register reg) {
+    auto code = std::to_underlying(reg);
+
+    if (code >= 8) {
+        emit_bytes({0x41});
+    }
+
+    emit_bytes({static_cast<uint8_t>(0x50 + (code & 7))});
+}
+
+void Codegen::pop_register(Register reg) {
+    auto code = std::to_underlying(reg);
+
+    if (code >= 8) {
+        emit_bytes({0x41});
+    }
+
+    emit_bytes({static_cast<uint8_t>(0x58 + (code & 7))});
+}
+
+void Codegen::xmm_gpr_instruction(
+    uint8_t critical_byte,
+    uint8_t xmm,
+    Register reg
+) {
+    auto code = std::to_underlying(reg);
+    auto rex = static_cast<uint8_t>(0x48 | code >> 3);
+
+    emit_bytes({0x66, rex, 0x0f, critical_byte, modrm(0b11, xmm, code & 7)});
+}
+
+void Codegen::load_variable(Instruction& instruction) {
+    if (auto home = variable_registers.find(instruction.parameter);
+        home != variable_registers.end()) {
+        push_register(home->second);
+        return;
+    }
+
+    emit_bytes({0xff, 0xb5});
+    emit_code_fragment(static_cast<uint32_t>(instruction.parameter + 1) * -8);
+}
+
+void Codegen::store_variable(Instruction& instruction) {
+    if (auto home = variable_registers.find(instruction.parameter);
+        home != variable_registers.end()) {
+        auto code = std::to_underlying(home->second);
+        auto rex = static_cast<uint8_t>(0x48 | (code >> 3) << 2);
+
+        emit_bytes({rex, 0x8b, modrm(0, code & 7, 0b100), 0x24});
+        return;
+    }
+
+    emit_bytes({0x48, 0x8b, 0x04, 0x24, 0x48, 0x89, 0x85});
+    emit_code_fragment(static_cast<uint32_t>(instruction.parameter + 1) * -8);
+}
+
+void Codegen::xmm_variable_instruction(
+    uint8_t critical_byte,
+    uint8_t xmm,
+    int idx
+) {
+    emit_bytes({0xf2, 0x0f, critical_byte, modrm(0b10, xmm, 0b101)});
+    emit_code_fragment(static_cast<uint32_t>(idx + 1) * -8);
+}
+
+void Codegen::xmm_stack_instruction(uint8_t critical_byte, uint8_t xmm) {
+    emit_bytes({0xf2, 0x0f, critical_byte, modrm(0, xmm, 0b100), 0x24});
+}
+
+auto Codegen::allocate_register() -> uint8_t {
+    if (register_slots.size() == XMM_REGISTER_COUNT) {
+        spill_register();
+    }
+
+    for (uint8_t xmm = 0;; ++xmm) {
+        if (std::ranges::find(register_slots, xmm) == register_slots.end()) {
+            return xmm;
+        }
+    }
+}
+
+void Codegen::spill_register() {
+    emit_bytes({0x48, 0x83, 0xec, 0x08});
+    xmm_stack_instruction(0x11, register_slots.front());
+    ++stack_depth;
+    register_slots.erase(register_slots.begin());
+}
+
+void Codegen::flush_registers() {
+    while (!register_slots.empty()) {
+        spill_register();
+    }
+}
+
+void Codegen::load_operands(size_t count) {
+    while (register_slots.size() < count) {
+        uint8_t xmm = allocate_register();
+
+        xmm_stack_instruction(0x10, xmm);
+        emit_bytes({0x48, 0x83, 0xc4, 0x08});
+        register_slots.insert(register_slots.begin(), xmm);
+        --stack_depth;
+    }
+}
+
+void Codegen::register_arith_instruction(uint8_t critical_byte, int constant) {
+    if (constant != -1) {
+        load_operands(1);
+        emit_bytes(
+            {0xf2, 0x0f, critical_byte, modrm(0, register_slots.back(), 0b101)}
+        );
+        emit_constant(constant);
+        return;
+    }
+
+    load_operands(2);
+
+    uint8_t right = register_slots.back();
+    register_slots.pop_back();
+    uint8_t left = register_slots.back();
+
+    emit_bytes({0xf2, 0x0f, critical_byte, modrm(0b11, left, right)});
+}
+
+void Codegen::compare_registers(int constant) {
+    size_t operand_count = constant != -1 ? 1 : 2;
+
+    load_operands(operand_count);
+
+    while (register_slots.size() > operand_count) {
+        spill_register();
+    }
+
+    uint8_t left = register_slots[0];
+
+    if (constant != -1) {
+        emit_bytes({0x66, 0x0f, 0x2f, modrm(0, left, 0b101)});
+        emit_constant(constant);
+    } else {
+        emit_bytes({0x66, 0x0f, 0x2f, modrm(0b11, left, register_slots[1])});
+    }
+
+    register_slots.clear();
+}
+
+void Codegen::register_comparison_instruction(
+    uint8_t critical_byte,
+    int constant
+) {
+    emit_bytes({0x48, 0x31, 0xc9});
+    compare_registers(constant);
+    emit_bytes(
+        {unsigned_condition(critical_byte), 0x03, 0x48, 0xff, 0xc1, 0x51}
+    );
+}
+
+void Codegen::register_branch_instruction(
+    Instruction& instruction,
+    int constant
+) {
+    compare_registers(constant);
+    conditional_jump(
+        unsigned_condition(branch_condition(instruction.opcode)),
+        instruction.parameter
+    );
+}
+
+auto Codegen::translate_register_instruction(
+    Instruction& instruction,
+    int constant
+) -> bool {
+    switch (instruction.opcode) {
+        case Opcode::Literal:
+            if (std::holds_alternative<double>(instruction.value)) {
+                double value = get<double>(instruction.value);
+                uint8_t xmm = allocate_register();
+
+                if (std::bit_cast<uint64_t>(value) == 0) {
+                    emit_bytes({0x66, 0x0f, 0x57, modrm(0b11, xmm, xmm)});
+                } else if (constant_operands) {
+                    emit_bytes({0xf2, 0x0f, 0x10, modrm(0, xmm, 0b101)});
+                    emit_constant(pool.add(std::bit_cast<uint64_t>(value)));
+                } else {
+                    emit_bytes({0x48, 0xb8});
+                    emit_code_fragment(value);
+                    emit_bytes({0x66, 0x48, 0x0f, 0x6e, modrm(0b11, xmm, 0)});
+                }
+
+                register_slots.push_back(xmm);
+                return true;
+            }
+            return false;
+        case Opcode::Identifier:
+            if (instruction.type == NUMBER) {
+                uint8_t xmm = allocate_register();
+
+                if (variable_registers.contains(instruction.parameter)) {
+                    xmm_gpr_instruction(
+                        0x6e,
+                        xmm,
+                        variable_registers[instruction.parameter]
+                    );
+                } else {
+                    xmm_variable_instruction(0x10, xmm, instruction.parameter);
+                }
+
+                register_slots.push_back(xmm);
+                return true;
+            }
+            return false;
+        case Opcode::Assign:
+            if (instruction.type == NUMBER) {
+                load_operands(1);
+
+                if (variable_registers.contains(instruction.parameter)) {
+                    xmm_gpr_instruction(
+                        0x7e,
+                        register_slots.back(),
+                        variable_registers[instruction.parameter]
+                    );
+                } else {
+                    xmm_variable_instruction(
+                        0x11,
+                        register_slots.back(),
+                        instruction.parameter
+                    );
+                }
+                return true;
+            }
+            return false;
+        case Opcode::Add:
+            register_arith_instruction(0x58, constant);
+            return true;
+        case Opcode::Subtract:
+            register_arith_instruction(0x5c, constant);
+            return true;
+        case Opcode::Multiply:
+            register_arith_instruction(0x59, constant);
+            return true;
+        case Opcode::Divide:
+            register_arith_instruction(0x5e, constant);
+            return true;
+        case Opcode::Minus: {
+            load_operands(1);
+            uint8_t xmm = register_slots.back();
+            emit_bytes({0x66, 0x48, 0x0f, 0x7e, modrm(0b11, xmm, 0)});
+            emit_bytes({0x48, 0x0f, 0xba, 0xf8, 0x3f});
+            emit_bytes({0x66, 0x48, 0x0f, 0x6e, modrm(0b11, xmm, 0)});
+            return true;
+        }
+        case Opcode::Equal:
+        case Opcode::NotEqual:
+        case Opcode::Less:
+        case Opcode::LessEqual:
+        case Opcode::Greater:
+        case Opcode::GreaterEqual:
+            register_comparison_instruction(
+                COMPARISON_CONDITIONS[std::to_underlying(instruction.opcode)
+                                      - std::to_underlying(Opcode::Equal)],
+                constant
+            );
+            return true;
+        case Opcode::JumpEqual:
+        case Opcode::JumpNotEqual:
+        case Opcode::JumpLess:
+        case Opcode::JumpLessEqual:
+        case Opcode::JumpGreater:
+        case Opcode::JumpGreaterEqual:
+            register_branch_instruction(instruction, constant);
+            return true;
+        case Opcode::ArrayElement:
+            if (inline_array_access) {
+                inline_array_element(instruction);
+                return true;
+            }
+            return false;
+        case Opcode::Pop: {
+            size_t cached =
+                std::min<size_t>(instruction.parameter, register_slots.size());
+            register_slots.resize(register_slots.size() - cached);
+
+            if (instruction.parameter != cached) {
+                emit_bytes({0x48, 0x81, 0xc4});
+                emit_code_fragment(
+                    static_cast<uint32_t>(instruction.parameter - cached) * 8
+                );
+            }
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+auto Codegen::translate_constant_operand(
+    Instruction& literal,
+    Instruction& next
+) -> bool {
+    if (literal.opcode != Opcode::Literal
+        || !std::holds_alternative<double>(literal.value)) {
+        return false;
+    }
+
+    switch (next.opcode) {
+        case Opcode::Add:
+        case Opcode::Subtract:
+        case Opcode::Multiply:
+        case Opcode::Divide:
+        case Opcode::Equal:
+        case Opcode::NotEqual:
+        case Opcode::Less:
+        case Opcode::LessEqual:
+        case Opcode::Greater:
+        case Opcode::GreaterEqual:
+        case Opcode::JumpEqual:
+        case Opcode::JumpNotEqual:
+        case Opcode::JumpLess:
+        case Opcode::JumpLessEqual:
+        case Opcode::JumpGreater:
+        case Opcode::JumpGreaterEqual:
+            break;
+        default:
+            return false;
+    }
+
+    literal.code_offset = code_len;
+    next.code_offset = code_len;
+
+    uint64_t value = std::bit_cast<uint64_t>(get<double>(literal.value));
+    return translate_register_instruction(next, pool.add(value));
+}
+
+void Codegen::inline_array_element(Instruction& instruction) {
+    auto length_offset = static_cast<uint8_t>(offsetof(lib::Array, length));
+    auto data_offset = static_cast<uint8_t>(offsetof(lib::Array, data));
+
+    if (register_slots.empty()) {
+        emit_bytes({0x58, 0x66, 0x48, 0x0f, 0x6e, 0xc0});
+        emit_bytes({0xf2, 0x48, 0x0f, 0x2d, 0xd0});
+    } else {
+        uint8_t xmm = register_slots.back();
+        register_slots.pop_back();
+        emit_bytes({0xf2, 0x48, 0x0f, 0x2d, modrm(0b11, 2, xmm)});
+    }
+
+    emit_bytes({0x59, 0x48, 0x3b, 0x51, length_offset});
+
+    unwind_fixups.push_back(code_len + 2);
+    emit_bytes({0x0f, 0x83, 0, 0, 0, 0});
+
+    emit_bytes({0x48, 0x8b, 0x49, data_offset});
+
+    if (instruction.type == BOOLEAN) {
+        emit_bytes({0x0f, 0xb6, 0x04, 0x11, 0x50});
+    } else if (register_stack && instruction.type == NUMBER) {
+        uint8_t xmm = allocate_register();
+        emit_bytes({0xf2, 0x0f, 0x10, modrm(0, xmm, 0b100), 0xd1});
+        register_slots.push_back(xmm);
+    } else {
+        emit_bytes({0x48, 0x8b, 0x04, 0xd1, 0x50});
+    }
 }
 
 void Codegen::translate_function_call(Instruction& instruction) {
@@ -225,7 +740,7 @@ void Codegen::translate_function_call(Instruction& instruction) {
     }
 
     if (func_sig.return_type == STRING) {
-        setup_immediate_integral_arg(0, std::bit_cast<uint64_t>(&runtime));
+        setup_runtime_arg(0);
     }
 
     emit_call(func_sig.entry_point);
@@ -241,8 +756,12 @@ void Codegen::translate_lrt(Instruction& instruction) {
             uint64_t type_desc = *std::bit_cast<uint64_t*>(&instruction.type);
 
             setup_immediate_integral_arg(2, item_count);
-            setup_immediate_integral_arg(1, type_desc);
-            setup_immediate_integral_arg(0, std::bit_cast<uint64_t>(&runtime));
+            if (constant_operands) {
+                setup_constant_arg(1, 0x8b, pool.add(type_desc));
+            } else {
+                setup_immediate_integral_arg(1, type_desc);
+            }
+            setup_runtime_arg(0);
 
             emit_call(reinterpret_cast<void*>(lib::Runtime::allocate_array));
 
@@ -251,16 +770,62 @@ void Codegen::translate_lrt(Instruction& instruction) {
 
             place_result_on_stack(false);
         } break;
-        case 1:
+        case 3: {
+            uint8_t runtime_reg = std::to_underlying(RUNTIME_REGISTER) & 0b111;
+            uint32_t literal =
+                module.add_literal(get<std::string>(instruction.value));
+
+            emit_bytes({0x49, 0x8b, modrm(0b10, 0, runtime_reg)});
+            emit_code_fragment(
+                static_cast<uint32_t>(offsetof(lib::Runtime, literals))
+            );
+            emit_bytes({0x48, 0x8d, modrm(0b10, 0, 0)});
+            emit_code_fragment(
+                static_cast<uint32_t>(literal * sizeof(std::string))
+            );
+            place_result_on_stack(false);
+        } break;
+        case 8:
+            setup_runtime_arg(0);
+            emit_call(reinterpret_cast<void*>(lib::Runtime::post_exec_cleanup));
+            break;
+        case 9: {
+            auto const& data = get<std::vector<uint64_t>>(instruction.value);
+            uint64_t type_desc = *std::bit_cast<uint64_t*>(&instruction.type);
+
+            setup_constant_arg(2, 0x8d, pool.add(data));
+            if (constant_operands) {
+                setup_constant_arg(1, 0x8b, pool.add(type_desc));
+            } else {
+                setup_immediate_integral_arg(1, type_desc);
+            }
+            setup_runtime_arg(0);
+
+            emit_call(reinterpret_cast<void*>(lib::Runtime::copy_array));
+            place_result_on_stack(false);
+        } break;
+        default:
+            break;
+    }
+}
+
+void Codegen::translate_runtime_operation(Instruction& instruction) {
+    switch (instruction.opcode) {
+        case Opcode::ArrayElement:
+            if (inline_array_access) {
+                inline_array_element(instruction);
+                break;
+            }
+
             setup_argument(0, true);
             emit_bytes({0xf2, 0x48, 0x0f, 0x2d, 0xd0});
 
             setup_argument(1, false);
-            setup_immediate_integral_arg(0, std::bit_cast<uint64_t>(&runtime));
+            setup_runtime_arg(0);
             emit_call(reinterpret_cast<void*>(lib::Runtime::array_element));
             place_result_on_stack(false);
 
-            setup_immediate_integral_arg(0, std::bit_cast<uint64_t>(&runtime));
+            setup_runtime_arg(0);
             emit_call(reinterpret_cast<void*>(lib::Runtime::check_exception));
 
             emit_bytes({0x48, 0x09, 0xc0});
@@ -268,52 +833,38 @@ void Codegen::translate_lrt(Instruction& instruction) {
             unwind_fixups.push_back(code_len + 2);
             emit_bytes({0x0f, 0x85, 0, 0, 0, 0});
             break;
-        case 2:
+        case Opcode::Append:
             setup_argument(1, false);
             setup_argument(0, false);
             emit_call(reinterpret_cast<void*>(lib::Runtime::append_element));
             place_result_on_stack(false);
             break;
-        case 3:
-            setup_immediate_integral_arg(
-                1,
-                std::bit_cast<uint64_t>(&get<std::string>(instruction.value))
-            );
-            setup_immediate_integral_arg(0, std::bit_cast<uint64_t>(&runtime));
-            emit_call(reinterpret_cast<void*>(lib::Runtime::allocate_string));
-            place_result_on_stack(false);
-            break;
-        case 4:
+        case Opcode::Concat:
             setup_argument(2, false);
             setup_argument(1, false);
-            setup_immediate_integral_arg(0, std::bit_cast<uint64_t>(&runtime));
+            setup_runtime_arg(0);
             emit_call(reinterpret_cast<void*>(lib::Runtime::cat_string));
             place_result_on_stack(false);
             break;
-        case 5:
+        case Opcode::NumberToString:
             setup_argument(0, true);
-            setup_immediate_integral_arg(0, std::bit_cast<uint64_t>(&runtime));
+            setup_runtime_arg(0);
             emit_call(reinterpret_cast<void*>(lib::Runtime::number_to_string));
             place_result_on_stack(false);
             break;
-        case 6: {
-            int64_t comparison = get<double>(instruction.value);
-            setup_immediate_integral_arg(2, comparison);
+        case Opcode::CompareString:
+            setup_immediate_integral_arg(2, instruction.parameter);
             setup_argument(1, false);
             setup_argument(0, false);
             emit_call(reinterpret_cast<void*>(lib::Runtime::strcmp));
             place_result_on_stack(false);
-        } break;
-        case 7:
+            break;
+        case Opcode::CompareArray:
             setup_argument(1, false);
             setup_argument(0, false);
             emit_call(reinterpret_cast<void*>(lib::Runtime::arrcmp));
             place_result_on_stack(false);
             break;
-        case 8:
-            setup_immediate_integral_arg(0, std::bit_cast<uint64_t>(&runtime));
-            emit_call(reinterpret_cast<void*>(lib::Runtime::post_exec_cleanup));
-            break;
         default:
             break;
     }
@@ -322,30 +873,39 @@ void Codegen::translate_lrt(Instruction& instruction) {
 void Codegen::translate_instruction(Instruction& instruction) {
     instruction.code_offset = code_len;
 
+    if (register_stack && translate_register_instruction(instruction)) {
+        return;
+    }
+
+    flush_registers();
+
     switch (instruction.opcode) {
         case Opcode::Assign:
-            emit_bytes({0x48, 0x8b, 0x04, 0x24, 0x48, 0x89, 0x85});
-            emit_code_fragment(
-                static_cast<uint32_t>(instruction.parameter + 1) * -8
-            );
+            store_variable(instruction);
             break;
         case Opcode::Equal:
-            comparison_instruction(instruction.type, 0x75);
+            comparison_instruction(true, 0x75);
             break;
         case Opcode::NotEqual:
-            comparison_instruction(instruction.type, 0x74);
+            comparison_instruction(true, 0x74);
             break;
         case Opcode::Less:
-            comparison_instruction(instruction.type, 0x7d);
+            comparison_instruction(true, 0x7d);
             break;
         case Opcode::LessEqual:
-            comparison_instruction(instruction.type, 0x7f);
+            comparison_instruction(true, 0x7f);
             break;
         case Opcode::Greater:
-            comparison_instruction(instruction.type, 0x7e);
+            comparison_instruction(true, 0x7e);
             break;
         case Opcode::GreaterEqual:
-            comparison_instruction(instruction.type, 0x7c);
+            comparison_instruction(true, 0x7c);
+            break;
+        case Opcode::EqualBoolean:
+            comparison_instruction(false, 0x75);
+            break;
+        case Opcode::NotEqualBoolean:
+            comparison_instruction(false, 0x74);
             break;
         case Opcode::Add:
             xmm_arith_instruction(0x58);
@@ -386,21 +946,41 @@ void Codegen::translate_instruction(Instruction& instruction) {
             break;
         }
         case Opcode::Jump:
+            jump_fixups.emplace_back(code_len + 1, instruction.parameter);
             emit_bytes({0xe9, 0x00, 0x00, 0x00, 0x00});
             break;
         case Opcode::JumpFalse:
+            jump_fixups.emplace_back(code_len + 6, instruction.parameter);
             emit_bytes(
                 {0x58, 0x48, 0x09, 0xc0, 0x0f, 0x84, 0x00, 0x00, 0x00, 0x00}
             );
             break;
-        case Opcode::Identifier:
-            emit_bytes({0xff, 0xb5});
-            emit_code_fragment(
-                static_cast<uint32_t>(instruction.parameter + 1) * -8
+        case Opcode::JumpTrue:
+            jump_fixups.emplace_back(code_len + 6, instruction.parameter);
+            emit_bytes(
+                {0x58, 0x48, 0x09, 0xc0, 0x0f, 0x85, 0x00, 0x00, 0x00, 0x00}
             );
             break;
+        case Opcode::JumpEqual:
+        case Opcode::JumpNotEqual:
+        case Opcode::JumpLess:
+        case Opcode::JumpLessEqual:
+        case Opcode::JumpGreater:
+        case Opcode::JumpGreaterEqual:
+        case Opcode::JumpEqualBoolean:
+        case Opcode::JumpNotEqualBoolean:
+            branch_instruction(instruction);
+            break;
+        case Opcode::Identifier:
+            load_variable(instruction);
+            break;
         case Opcode::Literal:
-            if (std::holds_alternative<double>(instruction.value)) {
+            if (std::holds_alternative<double>(instruction.value)
+                && constant_operands) {
+                double value = get<double>(instruction.value);
+                emit_bytes({0xff, 0x35});
+                emit_constant(pool.add(std::bit_cast<uint64_t>(value)));
+            } else if (std::holds_alternative<double>(instruction.value)) {
                 emit_bytes({0x48, 0xb8});
                 emit_code_fragment(get<double>(instruction.value));
                 emit_bytes({0x50});
@@ -411,6 +991,14 @@ void Codegen::translate_instruction(Instruction& instruction) {
         case Opcode::CallLRT:
             translate_lrt(instruction);
             break;
+        case Opcode::ArrayElement:
+        case Opcode::Append:
+        case Opcode::Concat:
+        case Opcode::NumberToString:
+        case Opcode::CompareString:
+        case Opcode::CompareArray:
+            translate_runtime_operation(instruction);
+            break;
         default:
             break;
     }
@@ -419,28 +1007,136 @@ void Codegen::translate_instruction(Instruction& instruction) {
 void Codegen::backpatch_instructions(
     std::vector<Instruction>& instructions
 ) const {
-    for (size_t idx = 0; idx < instructions.size(); ++idx) {
-        auto& instruction = instructions[idx];
-
-        if (instruction.opcode == Opcode::Jump
-            || instruction.opcode == Opcode::JumpFalse) {
-            int target = instructions[instruction.parameter].code_offset;
-            int next_offset = instructions[idx + 1].code_offset;
-            *std::bit_cast<uint32_t*>(code_base + next_offset - 4) =
-                target - next_offset;
+    for (auto [fixup, target_idx] : jump_fixups) {
+        int target = instructions[target_idx].code_offset;
+        *std::bit_cast<uint32_t*>(arena.base + fixup) = target - fixup - 4;
+    }
+}
+
+void Codegen::record_line_symbols(
+    std::vector<Instruction> const& instructions
+) {
+    uint32_t start = 0;
+    int line = 0;
+
+    for (auto const& instruction : instructions) {
+        auto offset = static_cast<uint32_t>(instruction.code_offset);
+
+        if (instruction.line_number == line) {
+            continue;
         }
+
+        if (offset > start) {
+            module.line_symbols.push_back({start, offset - start, line});
+        }
+
+        start = offset;
+        line = instruction.line_number;
     }
+
+    auto end = static_cast<uint32_t>(code_len);
+    module.line_symbols.push_back({start, end - start, line});
 }
 
 auto Codegen::generate(Program& program) -> DynamicFunction* {
-    emit_prologue(program.symbol_table.size());
+    std::unordered_set<int> jump_targets;
 
-    for (auto& instruction : program.instructions) {
-        translate_instruction(instruction);
+    for (auto const& instruction : program.instructions) {
+        if (instruction.is_jump()) {
+            jump_targets.insert(instruction.parameter);
+        }
+    }
+
+    for (auto const& [symbol, descriptor] : program.symbol_table) {
+        if (descriptor.home != -1) {
+            variable_registers[descriptor.idx] =
+                promotion_registers[descriptor.home];
+        }
+    }
+
+    saved_registers.push_back(RUNTIME_REGISTER);
+
+    for (auto reg : promotion_registers) {
+        if (std::ranges::any_of(variable_registers, [&](auto const& entry) {
+                return entry.second == reg;
+            })) {
+            saved_registers.push_back(reg);
+        }
+    }
+
+    emit_prologue(program.variable_count());
+
+    auto& instructions = program.instructions;
+    std::vector<std::pair<size_t, int>> profile_boundaries;
+
+    for (size_t idx = 0; idx < instructions.size(); ++idx) {
+        if (jump_targets.contains(idx)) {
+            flush_registers();
+        }
+
+        if (profile && instructions[idx].line_number != profile_line) {
+            profile_boundaries.emplace_back(idx, code_len);
+            profile_statement(instructions[idx].line_number);
+        }
+
+        stack_depth = instructions[idx].stack_depth
+            - static_cast<int>(register_slots.size());
+
+        if (register_stack && constant_operands
+            && idx + 1 < instructions.size() && !jump_targets.contains(idx + 1)
+            && translate_constant_operand(
+                instructions[idx],
+                instructions[idx + 1]
+            )) {
+            ++idx;
+            continue;
+        }
+
+        translate_instruction(instructions[idx]);
     }
 
     emit_epilogue();
-    backpatch_instructions(program.instructions);
 
-    return std::bit_cast<DynamicFunction*>(create_code_base());
+    // Fixups may point past the end of code that stopped short.
+    if (truncated) {
+        return nullptr;
+    }
+
+    for (auto [idx, offset] : profile_boundaries) {
+        instructions[idx].code_offset = offset;
+    }
+
+    backpatch_instructions(instructions);
+    record_line_symbols(instructions);
+    emit_constant_pool();
+
+    if (truncated) {
+        return nullptr;
+    }
+
+    return std::bit_cast<DynamicFunction*>(arena.seal());
+}
+
+auto Codegen::relocatable() -> Module& {
+    module.code.assign(arena.base, arena.base + code_len);
+    return module;
+}
+
+auto unsigned_condition(uint8_t critical_byte) -> uint8_t {
+    if (critical_byte > 0x78) {
+        return ((critical_byte << 1) & 0b100) | 0b10
+            | (critical_byte & static_cast<uint8_t>(0xf1));
+    }
+
+    return critical_byte;
+}
+
+auto branch_condition(Opcode opcode) -> uint8_t {
+    auto idx =
+        std::to_underlying(opcode) - std::to_underlying(Opcode::JumpEqual);
+    return COMPARISON_CONDITIONS.at(idx) ^ 1;
+}
+
+auto modrm(uint8_t mod, uint8_t reg, uint8_t rm) -> uint8_t {
+    return mod << 6 | reg << 3 | rm;
 }
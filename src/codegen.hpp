@@ -1,55 +1,138 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <initializer_list>
+#include "arena.hpp"
+#include "constant_pool.hpp"
 #include "context.hpp"
 #include "lang_runtime.hpp"
+#include "module.hpp"
+#include "optimize.hpp"
+#include "promote.hpp"
 
 using dgeval::ast::FunctionSignature;
 using dgeval::ast::Instruction;
 using dgeval::ast::NUMBER;
 using dgeval::ast::Opcode;
+using dgeval::ast::Optimization;
+using dgeval::ast::OptimizationFlags;
 using dgeval::ast::Program;
+using dgeval::ast::PROMOTION_REGISTER_COUNT;
 using dgeval::ast::RUNTIME_LIBRARY;
 using dgeval::ast::STRING;
 using dgeval::ast::Type;
 using dgeval::ast::TypeDescriptor;
 using std::size_t;
 
-const int DELTA = 16;
+const uint8_t XMM_REGISTER_COUNT = 8;
+const std::array<uint8_t, 6> COMPARISON_CONDITIONS =
+    {0x75, 0x74, 0x7d, 0x7f, 0x7e, 0x7c};
 
-enum class Register : uint8_t { RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI };
+enum class Register : uint8_t {
+    RAX,
+    RCX,
+    RDX,
+    RBX,
+    RSP,
+    RBP,
+    RSI,
+    RDI,
+    R8,
+    R9,
+    R10,
+    R11,
+    R12,
+    R13,
+    R14,
+    R15,
+};
 
-using DynamicFunction = void();
+const Register RUNTIME_REGISTER = Register::R15;
 
 class Codegen {
   public:
-    ~Codegen();
+    Codegen(OptimizationFlags flags);
     void emit_bytes(std::initializer_list<uint8_t> bytes);
     template<typename T>
     void emit_code_fragment(T code_fragment);
-    [[nodiscard]] auto create_code_base() const -> void*;
     void emit_prologue(int variable_count);
     void emit_epilogue();
     void xmm_arith_instruction(uint8_t critical_byte);
-    void
-    comparison_instruction(TypeDescriptor type_desc, uint8_t critical_byte);
+    void comparison_instruction(bool number, uint8_t critical_byte);
     void setup_argument(int idx, bool is_double);
     void emit_call(void* call_address);
+    void emit_timestamp();
+    void begin_profile_sample(size_t start_field);
+    void end_profile_sample(size_t start_field, int site);
+    void profile_statement(int line);
+    auto profile_site(int line, std::string const& callee) -> int;
+    void conditional_jump(uint8_t condition, int target);
+    void branch_instruction(Instruction& instruction);
     void setup_immediate_integral_arg(int idx, uint64_t arg);
+    void setup_runtime_arg(int idx);
     void setup_immediate_double_arg(int idx, double arg);
+    void setup_constant_arg(int idx, uint8_t critical_byte, int constant);
+    void emit_constant(int constant);
+    void emit_constant_pool();
     void place_result_on_stack(bool is_double);
+    void push_register(Register reg);
+    void pop_register(Register reg);
+    void xmm_gpr_instruction(uint8_t critical_byte, uint8_t xmm, Register reg);
+    void load_variable(Instruction& instruction);
+    void store_variable(Instruction& instruction);
+    void xmm_variable_instruction(uint8_t critical_byte, uint8_t xmm, int idx);
+    void xmm_stack_instruction(uint8_t critical_byte, uint8_t xmm);
+    auto allocate_register() -> uint8_t;
+    void spill_register();
+    void flush_registers();
+    void load_operands(size_t count);
+    void register_arith_instruction(uint8_t critical_byte, int constant = -1);
+    void compare_registers(int constant = -1);
+    void
+    register_comparison_instruction(uint8_t critical_byte, int constant = -1);
+    void
+    register_branch_instruction(Instruction& instruction, int constant = -1);
+    auto
+    translate_register_instruction(Instruction& instruction, int constant = -1)
+        -> bool;
+    auto translate_constant_operand(Instruction& literal, Instruction& next)
+        -> bool;
+    void inline_array_element(Instruction& instruction);
     void translate_function_call(Instruction& instruction);
     void translate_lrt(Instruction& instruction);
+    void translate_runtime_operation(Instruction& instruction);
     void translate_instruction(Instruction& instruction);
     void backpatch_instructions(std::vector<Instruction>& instructions) const;
+    void record_line_symbols(std::vector<Instruction> const& instructions);
     auto generate(Program& program) -> DynamicFunction*;
+    auto relocatable() -> Module&;
 
-    lib::Runtime runtime;
     static std::array<Register, 4> registers;
-    uint8_t* code_base {std::bit_cast<uint8_t*>(malloc(DELTA))};
-    size_t bag_size {DELTA};
+    static std::array<Register, PROMOTION_REGISTER_COUNT> promotion_registers;
+    CodeArena arena;
+    ConstantPool pool;
+    Module module;
     size_t code_len {0};
     size_t unwind_location;
     std::vector<int> unwind_fixups;
+    std::vector<std::pair<int, int>> jump_fixups;
+    std::vector<std::pair<int, int>> constant_fixups;
+    std::vector<uint8_t> register_slots;
+    std::unordered_map<int, Register> variable_registers;
+    std::vector<Register> saved_registers;
+    std::vector<lib::ProfileSite> profile_sites;
+    int frame_size {};
+    int stack_depth {};
+    int profile_line {};
+    bool register_stack {true};
+    bool inline_array_access {true};
+    bool constant_operands {true};
+    bool profile {false};
+    // Set when the arena could not grow, so the emitted code is incomplete.
+    bool truncated {false};
 };
+
+auto unsigned_condition(uint8_t critical_byte) -> uint8_t;
+auto branch_condition(Opcode opcode) -> uint8_t;
+auto modrm(uint8_t mod, uint8_t reg, uint8_t rm) -> uint8_t;
@@ -0,0 +1,47 @@
+#include "constant_pool.hpp"
+#include <cstring>
+
+auto ConstantPool::add(uint64_t value) -> int {
+    if (auto entry = qwords.find(value); entry != qwords.end()) {
+        return entry->second;
+    }
+
+    data.resize((data.size() + 7) & ~size_t {7});
+
+    int offset = static_cast<int>(data.size());
+    data.resize(data.size() + sizeof(value));
+    std::memcpy(data.data() + offset, &value, sizeof(value));
+    qwords.emplace(value, offset);
+
+    return offset;
+}
+
+auto ConstantPool::add(std::string_view value) -> int {
+    if (auto entry = strings.find(std::string(value)); entry != strings.end()) {
+        return entry->second;
+    }
+
+    int offset = static_cast<int>(data.size());
+    data.insert(data.end(), value.begin(), value.end());
+    data.push_back(0);
+    strings.emplace(value, offset);
+
+    return offset;
+}
+
+auto ConstantPool::add(std::span<uint64_t const> values) -> int {
+    std::vector<uint64_t> block(values.begin(), values.end());
+
+    if (auto entry = blocks.find(block); entry != blocks.end()) {
+        return entry->second;
+    }
+
+    data.resize((data.size() + 7) & ~size_t {7});
+
+    int offset = static_cast<int>(data.size());
+    data.resize(data.size() + values.size_bytes());
+    std::memcpy(data.data() + offset, values.data(), values.size_bytes());
+    blocks.emplace(std::move(block), offset);
+
+    return offset;
+}
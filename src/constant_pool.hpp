@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+class ConstantPool {
+  public:
+    auto add(uint64_t value) -> int;
+    auto add(std::string_view value) -> int;
+    auto add(std::span<uint64_t const> values) -> int;
+
+    std::vector<uint8_t> data;
+    std::unordered_map<uint64_t, int> qwords;
+    std::unordered_map<std::string, int> strings;
+    std::map<std::vector<uint64_t>, int> blocks;
+};
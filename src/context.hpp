@@ -5,6 +5,7 @@
 #include <unordered_map>
 #include "ast.hpp"
 #include "linear_ir.hpp"
+#include "value_graph.hpp"
 
 namespace dgeval::ast {
 
@@ -62,6 +63,10 @@ class Program {
         });
     }
 
+    [[nodiscard]] auto variable_count() const -> size_t {
+        return symbol_table.size() + temporary_count;
+    }
+
     auto any_errors() -> bool {
         return std::count_if(
                    messages.begin(),
@@ -76,7 +81,10 @@ class Program {
     std::unique_ptr<StatementList> statements;
     std::unordered_map<std::string, SymbolDescriptor> symbol_table;
     std::unique_ptr<StatementList> circular_statements;
+    std::unique_ptr<StatementList> dead_statements;
     std::vector<Instruction> instructions;
+    ValueGraph graph;
+    int temporary_count {};
     std::vector<Message> messages;
 };
 
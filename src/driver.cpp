@@ -2,7 +2,7 @@
 #include "parser.hpp"
 #include "scanner.hpp"
 
-auto Driver::parse(std::ifstream& input) -> int {
+auto Driver::parse(std::istream& input) -> int {
     Lexer lexer;
     lexer.switch_streams(&input);
 
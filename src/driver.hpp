@@ -1,11 +1,11 @@
 #pragma once
 
-#include <fstream>
+#include <istream>
 #include "parser.hpp"
 
 class Driver {
   public:
-    auto parse(std::ifstream& input) -> int;
+    auto parse(std::istream& input) -> int;
 
     std::unique_ptr<dgeval::ast::Program> program;
     std::string buffer;
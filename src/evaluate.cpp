@@ -0,0 +1,88 @@
+#include "evaluate.hpp"
+#include "interpreter.hpp"
+#include "optimize.hpp"
+
+namespace dgeval::ast {
+
+PartialEvaluation::PartialEvaluation(OptimizationFlags flags) :
+    enabled(flags[Optimization::PartialEvaluation]) {}
+
+void PartialEvaluation::run(Program& program) const {
+    if (!enabled || program.any_errors() || reads_external_input(program)) {
+        return;
+    }
+
+    std::vector<PrintRecord> records;
+    Interpreter interpreter(program);
+    lib::Runtime runtime;
+
+    interpreter.record_prints(records);
+    interpreter.run(&runtime);
+
+    size_t output_size = 0;
+    for (auto const& record : records) {
+        output_size += record.text.size();
+    }
+
+    // Keep the module when its output is much larger than its code.
+    if (output_size > EVALUATION_OUTPUT_LIMIT) {
+        return;
+    }
+
+    std::vector<Instruction> instructions;
+
+    for (auto& record : records) {
+        int line = program.instructions[record.instruction].line_number;
+
+        if (!instructions.empty() && instructions.back().line_number == line) {
+            auto& literal = instructions[instructions.size() - 3];
+            get<std::string>(literal.value) += record.text;
+        } else {
+            emit_print(instructions, std::move(record.text), line);
+        }
+    }
+
+    instructions.emplace_back(Opcode::CallLRT, 8);
+    instructions.back().value = 0.0;
+
+    program.instructions = std::move(instructions);
+    program.temporary_count = 0;
+    check_stack_depth(program);
+}
+
+// Every impure function other than print, such as random, depends on state
+// outside the module.
+auto reads_external_input(Program const& program) -> bool {
+    return std::ranges::any_of(
+        program.instructions,
+        [](Instruction const& instruction) {
+            if (instruction.opcode != Opcode::Call) {
+                return false;
+            }
+
+            auto const& id = get<std::string>(instruction.value);
+            return id != "print" && !RUNTIME_LIBRARY.at(id).pure;
+        }
+    );
+}
+
+void emit_print(
+    std::vector<Instruction>& instructions,
+    std::string text,
+    int line_number
+) {
+    instructions.emplace_back(Opcode::CallLRT, 3, STRING);
+    instructions.back().value = std::move(text);
+
+    instructions.emplace_back(Opcode::Call, 1, NUMBER);
+    instructions.back().value = std::string("print");
+
+    instructions.emplace_back(Opcode::Pop, 1);
+
+    for (size_t idx = instructions.size() - 3; idx < instructions.size();
+         ++idx) {
+        instructions[idx].line_number = line_number;
+    }
+}
+
+} // namespace dgeval::ast
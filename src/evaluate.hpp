@@ -0,0 +1,28 @@
+#pragma once
+
+#include "context.hpp"
+
+namespace dgeval::ast {
+
+class OptimizationFlags;
+
+inline constexpr size_t EVALUATION_OUTPUT_LIMIT = 1 << 20;
+
+// Runs a module that takes no external input at compile time and replaces
+// its instructions with the print calls it made.
+class PartialEvaluation {
+  public:
+    PartialEvaluation(OptimizationFlags flags);
+    void run(Program& program) const;
+
+    bool enabled;
+};
+
+auto reads_external_input(Program const& program) -> bool;
+void emit_print(
+    std::vector<Instruction>& instructions,
+    std::string text,
+    int line_number
+);
+
+} // namespace dgeval::ast
@@ -1,8 +1,18 @@
 #include "fold.hpp"
+#include <bit>
+#include <cmath>
 #include "ast.hpp"
+#include "lang_runtime.hpp"
+#include "optimize.hpp"
 
 namespace dgeval::ast {
 
+Fold::Fold(OptimizationFlags flags) :
+    propagate(flags[Optimization::ConstantPropagation]),
+    simplify(flags[Optimization::AlgebraicSimplification]),
+    fast_math(flags[Optimization::FastMath]),
+    static_arrays(flags[Optimization::StaticArrays]) {}
+
 auto Fold::visit_program(Program& program) -> std::unique_ptr<Expression> {
     errors = std::move(program.messages);
     program.statements->accept(*this);
@@ -64,14 +74,45 @@ auto Fold::visit_array(ArrayLiteral& array) -> std::unique_ptr<Expression> {
         array.items = std::move(r);
     }
 
+    // Arrays of number and boolean literals are copied from read-only data
+    // instead of being built from the stack.
     array.opcode = Opcode::CallLRT;
-    array.idNdx = 0;
+    array.idNdx = static_arrays && array.type_desc.type != Type::String
+            && is_constant(*array.items)
+        ? 9
+        : 0;
 
     return nullptr;
 }
 
-auto Fold::visit_identifier(Identifier& /*identifier*/)
+auto Fold::visit_identifier(Identifier& identifier)
     -> std::unique_ptr<Expression> {
+    auto constant = constants.find(identifier.id);
+
+    if (opcode == Opcode::Assign || constant == constants.end()) {
+        return nullptr;
+    }
+
+    // Only a literal zero divisor is reported, so a propagated one is left
+    // to run time.
+    if (auto const& number = dynamic_cast<NumberLiteral*>(constant->second);
+        divisor && number && number->value == 0) {
+        return nullptr;
+    }
+
+    return clone_constant(*constant->second, identifier.loc);
+}
+
+// Only literals qualify: an append mutates the array a variable holds in
+// place, so a variable bound to a constant array may grow before it is read.
+auto Fold::constant_array(Expression const& expression) const
+    -> ArrayLiteral const* {
+    if (auto const& array = dynamic_cast<ArrayLiteral const*>(&expression)) {
+        if (is_constant(*array)) {
+            return array;
+        }
+    }
+
     return nullptr;
 }
 
@@ -80,24 +121,49 @@ auto Fold::visit_binary_expression(BinaryExpression& binary_expr)
     auto& left = binary_expr.left;
     auto& right = binary_expr.right;
     int comparison_parameter = 0;
+    bool conditional = binary_expr.opcode == Opcode::Conditional
+        || binary_expr.opcode == Opcode::And
+        || binary_expr.opcode == Opcode::Or;
+
+    opcode = binary_expr.opcode;
+    divisor = false;
 
     if (auto l = binary_expr.left->accept(*this)) {
         binary_expr.left = std::move(l);
     }
 
+    opcode = Opcode::None;
+    divisor = binary_expr.opcode == Opcode::Divide;
+    conditional_depth += conditional;
+
     if (right) {
         if (auto r = binary_expr.right->accept(*this)) {
             binary_expr.right = std::move(r);
         }
     }
 
+    divisor = false;
+    conditional_depth -= conditional;
+
     switch (binary_expr.opcode) {
+        case Opcode::Assign:
+            // Variables are assigned once, so a constant stored on every path
+            // through the statement holds for every later reader. Arrays are
+            // left out because appends change them in place.
+            if (propagate && conditional_depth == 0 && is_constant(*right)
+                && !right->type_desc.is_array()) {
+                auto const& id = dynamic_cast<Identifier*>(left.get())->id;
+                constants[id] = right.get();
+            }
+            break;
         case Opcode::Add:
             if (auto result = reduce_addition(binary_expr)) {
                 if (result->type_desc == STRING) {
                     result->accept(*this);
                 }
                 return result;
+            } else if (fast_math && binary_expr.type_desc == NUMBER) {
+                return reassociate(binary_expr);
             } else if (left->type_desc == STRING
                        && right->type_desc == STRING) {
                 binary_expr.opcode = Opcode::CallLRT;
@@ -108,11 +174,21 @@ auto Fold::visit_binary_expression(BinaryExpression& binary_expr)
             }
             break;
         case Opcode::Subtract:
-            return reduce_subtraction(binary_expr);
+            if (auto result = reduce_subtraction(binary_expr)) {
+                return result;
+            }
+            return fast_math ? simplify_subtraction(binary_expr) : nullptr;
         case Opcode::Multiply:
-            return reduce_multiplication(binary_expr);
+            if (auto result = reduce_multiplication(binary_expr)) {
+                return result;
+            }
+            return fast_math ? reassociate(binary_expr) : nullptr;
         case Opcode::Divide:
-            return reduce_division(binary_expr, errors);
+            if (auto result = reduce_division(binary_expr, errors)) {
+                return result;
+            }
+            return simplify ? reduce_reciprocal(binary_expr, fast_math)
+                            : nullptr;
         case Opcode::And:
         case Opcode::Or:
             return reduce_logical(binary_expr);
@@ -141,7 +217,32 @@ auto Fold::visit_binary_expression(BinaryExpression& binary_expr)
             break;
         case Opcode::Conditional:
             return reduce_ternary(binary_expr);
+        case Opcode::Call: {
+            std::vector<Expression const*> arguments;
+
+            if (right) {
+                collect_items(*right, arguments);
+            }
+
+            for (auto& argument : arguments) {
+                if (argument->type_desc.is_array()) {
+                    argument = constant_array(*argument);
+                }
+            }
+
+            if (auto result = reduce_call(binary_expr, arguments)) {
+                if (result->type_desc == STRING) {
+                    result->accept(*this);
+                }
+                return result;
+            }
+        } break;
         case Opcode::ArrayAccess:
+            if (auto const* array = constant_array(*left)) {
+                if (auto result = reduce_array_access(binary_expr, *array)) {
+                    return result;
+                }
+            }
             binary_expr.opcode = Opcode::CallLRT;
             binary_expr.idNdx = 1;
             break;
@@ -154,10 +255,21 @@ auto Fold::visit_binary_expression(BinaryExpression& binary_expr)
 
 auto Fold::visit_unary_expression(UnaryExpression& unary_expr)
     -> std::unique_ptr<Expression> {
+    opcode = Opcode::None;
+    divisor = false;
+
     if (auto r = unary_expr.left->accept(*this)) {
         unary_expr.left = std::move(r);
     }
 
+    // `!!b` and `-(-x)` cancel exactly.
+    if (auto const& inner =
+            dynamic_cast<UnaryExpression*>(unary_expr.left.get());
+        simplify && inner && inner->opcode == unary_expr.opcode
+        && (inner->opcode == Opcode::Not || inner->opcode == Opcode::Minus)) {
+        return std::move(inner->left);
+    }
+
     switch (unary_expr.opcode) {
         case Opcode::Not:
             if (auto const& boolean =
@@ -196,6 +308,182 @@ auto reduce_ternary(BinaryExpression& binary_expr)
     return nullptr;
 }
 
+auto is_constant(Expression const& expression) -> bool {
+    if (auto const& array = dynamic_cast<ArrayLiteral const*>(&expression)) {
+        return is_constant(*array->items);
+    }
+
+    if (auto const& comma =
+            dynamic_cast<BinaryExpression const*>(&expression)) {
+        return comma->opcode == Opcode::Comma && is_constant(*comma->left)
+            && is_constant(*comma->right);
+    }
+
+    return dynamic_cast<NumberLiteral const*>(&expression)
+        || dynamic_cast<StringLiteral const*>(&expression)
+        || dynamic_cast<BooleanLiteral const*>(&expression);
+}
+
+auto clone_constant(Expression const& constant, location loc)
+    -> std::unique_ptr<Expression> {
+    std::unique_ptr<Expression> clone;
+
+    if (auto const& number = dynamic_cast<NumberLiteral const*>(&constant)) {
+        clone = std::make_unique<NumberLiteral>(loc, number->value);
+    } else if (auto const& string =
+                   dynamic_cast<StringLiteral const*>(&constant)) {
+        clone = std::make_unique<StringLiteral>(loc, string->value);
+    } else if (auto const& boolean =
+                   dynamic_cast<BooleanLiteral const*>(&constant)) {
+        clone = std::make_unique<BooleanLiteral>(loc, boolean->value);
+    } else if (auto const& array =
+                   dynamic_cast<ArrayLiteral const*>(&constant)) {
+        auto copy = std::make_unique<ArrayLiteral>(
+            loc,
+            clone_constant(*array->items, loc)
+        );
+        copy->item_count = array->item_count;
+        clone = std::move(copy);
+    } else {
+        auto const& comma = dynamic_cast<BinaryExpression const&>(constant);
+        clone = std::make_unique<BinaryExpression>(
+            loc,
+            clone_constant(*comma.left, loc),
+            clone_constant(*comma.right, loc),
+            Opcode::Comma
+        );
+    }
+
+    clone->opcode = constant.opcode;
+    clone->type_desc = constant.type_desc;
+    clone->idNdx = constant.idNdx;
+    clone->stack_load = constant.stack_load;
+
+    return clone;
+}
+
+void collect_items(
+    Expression const& items,
+    std::vector<Expression const*>& out
+) {
+    if (items.opcode == Opcode::Comma) {
+        auto const& comma = dynamic_cast<BinaryExpression const&>(items);
+        collect_items(*comma.left, out);
+        collect_items(*comma.right, out);
+    } else {
+        out.push_back(&items);
+    }
+}
+
+auto reduce_array_access(
+    BinaryExpression& binary_expr,
+    ArrayLiteral const& array
+) -> std::unique_ptr<Expression> {
+    auto const& rn = dynamic_cast<NumberLiteral*>(binary_expr.right.get());
+    std::vector<Expression const*> items;
+
+    if (!rn || rn->value != std::trunc(rn->value)) {
+        return nullptr;
+    }
+
+    collect_items(*array.items, items);
+
+    if (rn->value < 0 || rn->value >= static_cast<double>(items.size())) {
+        return nullptr;
+    }
+
+    return clone_constant(
+        *items[static_cast<size_t>(rn->value)],
+        binary_expr.loc
+    );
+}
+
+auto reduce_call(
+    BinaryExpression& binary_expr,
+    std::vector<Expression const*> const& arguments
+) -> std::unique_ptr<Expression> {
+    auto const& id = dynamic_cast<Identifier*>(binary_expr.left.get())->id;
+    auto const& signature = RUNTIME_LIBRARY.at(id);
+
+    if (!signature.pure || arguments.size() != signature.parameter_count
+        || std::ranges::find(arguments, nullptr) != arguments.end()) {
+        return nullptr;
+    }
+
+    // The library entry points are called directly so that folded results
+    // are bit-identical to the ones computed at run time.
+    if (arguments.empty()) {
+        auto* function = std::bit_cast<double (*)()>(signature.entry_point);
+        return std::make_unique<NumberLiteral>(binary_expr.loc, function());
+    }
+
+    auto const& parameter = signature.parameters[0];
+    auto const& number = dynamic_cast<NumberLiteral const*>(arguments[0]);
+    auto const& string = dynamic_cast<StringLiteral const*>(arguments[0]);
+    auto const& array = dynamic_cast<ArrayLiteral const*>(arguments[0]);
+
+    if (parameter == NUMBER && number) {
+        auto* function =
+            std::bit_cast<double (*)(double)>(signature.entry_point);
+        return std::make_unique<NumberLiteral>(
+            binary_expr.loc,
+            function(number->value)
+        );
+    }
+
+    if (parameter.is_array() && array) {
+        std::vector<Expression const*> items;
+
+        collect_items(*array->items, items);
+
+        auto* numbers = lib::Array::create(NUMBER, items.size());
+        for (auto const* item : items) {
+            numbers->push_back(dynamic_cast<NumberLiteral const&>(*item).value);
+        }
+
+        auto* function =
+            std::bit_cast<double (*)(lib::Array*)>(signature.entry_point);
+        double result = function(numbers);
+
+        lib::Array::destroy(numbers);
+        return std::make_unique<NumberLiteral>(binary_expr.loc, result);
+    }
+
+    if (!string) {
+        return nullptr;
+    }
+
+    std::string value = string->value;
+
+    if (signature.return_type == NUMBER) {
+        auto* function =
+            std::bit_cast<double (*)(std::string&)>(signature.entry_point);
+        return std::make_unique<NumberLiteral>(
+            binary_expr.loc,
+            function(value)
+        );
+    }
+
+    auto const& count = dynamic_cast<NumberLiteral const*>(arguments[1]);
+
+    // Negative or NaN counts do not convert to a substring length, so
+    // those calls are left to run time.
+    if (!count || !(count->value >= 0)) {
+        return nullptr;
+    }
+
+    auto* function = std::bit_cast<
+        std::string* (*)(lib::Runtime*, std::string&, double)>(
+        signature.entry_point
+    );
+    lib::Runtime runtime;
+    std::string result = *function(&runtime, value, count->value);
+
+    lib::Runtime::post_exec_cleanup(&runtime);
+
+    return std::make_unique<StringLiteral>(binary_expr.loc, std::move(result));
+}
+
 auto reduce_comparison(BinaryExpression& binary_expr)
     -> std::unique_ptr<Expression> {
     if (binary_expr.left->opcode != Opcode::Literal
@@ -415,11 +703,14 @@ auto reduce_subtraction(BinaryExpression& binary_expr)
                 ln->value - rn->value
             );
         } else if (ln->value == 0) {
-            return std::make_unique<UnaryExpression>(
+            auto negation = std::make_unique<UnaryExpression>(
                 binary_expr.loc,
-                std::move(binary_expr.left),
+                std::move(binary_expr.right),
                 Opcode::Minus
             );
+            negation->type_desc = NUMBER;
+            negation->offload_count(*negation->left);
+            return negation;
         }
     }
 
@@ -487,4 +778,176 @@ auto reduce_division(
     return nullptr;
 }
 
+auto same_value(Expression const& a, Expression const& b) -> bool {
+    // Runtime library calls may raise exceptions, so they never match.
+    if (a.opcode != b.opcode || a.idNdx != b.idNdx || a.type_desc != b.type_desc
+        || a.opcode == Opcode::CallLRT || a.is_effective()
+        || b.is_effective()) {
+        return false;
+    }
+
+    if (auto const& an = dynamic_cast<NumberLiteral const*>(&a)) {
+        auto const& bn = dynamic_cast<NumberLiteral const*>(&b);
+        return bn && an->value == bn->value;
+    }
+
+    if (auto const& ab = dynamic_cast<BooleanLiteral const*>(&a)) {
+        auto const& bb = dynamic_cast<BooleanLiteral const*>(&b);
+        return bb && ab->value == bb->value;
+    }
+
+    if (auto const& ai = dynamic_cast<Identifier const*>(&a)) {
+        auto const& bi = dynamic_cast<Identifier const*>(&b);
+        return bi && ai->id == bi->id;
+    }
+
+    if (auto const& au = dynamic_cast<UnaryExpression const*>(&a)) {
+        auto const& bu = dynamic_cast<UnaryExpression const*>(&b);
+        return bu && same_value(*au->left, *bu->left);
+    }
+
+    if (auto const& ab = dynamic_cast<BinaryExpression const*>(&a)) {
+        auto const& bb = dynamic_cast<BinaryExpression const*>(&b);
+        return bb && ab->right && bb->right && same_value(*ab->left, *bb->left)
+            && same_value(*ab->right, *bb->right);
+    }
+
+    return false;
+}
+
+// Splits a number expression `x op c`, or `c op x` for commutative
+// operators, into its operand and constant. `x - c` is read as `x + -c`.
+auto split_constant(Expression& expression, Opcode opcode)
+    -> std::pair<std::unique_ptr<Expression>*, double> {
+    auto const& binary = dynamic_cast<BinaryExpression*>(&expression);
+
+    if (!binary || binary->type_desc != NUMBER) {
+        return {nullptr, 0};
+    }
+
+    auto const& ln = dynamic_cast<NumberLiteral*>(binary->left.get());
+    auto const& rn = dynamic_cast<NumberLiteral*>(binary->right.get());
+
+    if (binary->opcode == opcode) {
+        if (rn) {
+            return {&binary->left, rn->value};
+        } else if (ln) {
+            return {&binary->right, ln->value};
+        }
+    } else if (opcode == Opcode::Add && binary->opcode == Opcode::Subtract
+               && rn) {
+        return {&binary->left, -rn->value};
+    }
+
+    return {nullptr, 0};
+}
+
+auto make_binary(
+    location loc,
+    std::unique_ptr<Expression> operand,
+    double constant,
+    Opcode opcode
+) -> std::unique_ptr<Expression> {
+    auto binary = std::make_unique<BinaryExpression>(
+        loc,
+        std::move(operand),
+        std::make_unique<NumberLiteral>(loc, constant),
+        opcode
+    );
+
+    binary->type_desc = NUMBER;
+    binary->offload_count(*binary->left);
+
+    return binary;
+}
+
+// Regrouping changes how floating-point operations round, so this is only
+// done under FastMath.
+auto reassociate(BinaryExpression& binary_expr)
+    -> std::unique_ptr<Expression> {
+    auto opcode = binary_expr.opcode == Opcode::Multiply ? Opcode::Multiply
+                                                         : Opcode::Add;
+    auto const& ln = dynamic_cast<NumberLiteral*>(binary_expr.left.get());
+    auto const& rn = dynamic_cast<NumberLiteral*>(binary_expr.right.get());
+    std::pair<std::unique_ptr<Expression>*, double> inner {nullptr, 0};
+    double constant = 0;
+
+    if (rn) {
+        inner = split_constant(*binary_expr.left, opcode);
+        constant = binary_expr.opcode == Opcode::Subtract ? -rn->value
+                                                          : rn->value;
+    } else if (ln && binary_expr.opcode != Opcode::Subtract) {
+        inner = split_constant(*binary_expr.right, opcode);
+        constant = ln->value;
+    }
+
+    auto [operand, inner_constant] = inner;
+
+    if (!operand) {
+        return nullptr;
+    }
+
+    if (opcode == Opcode::Multiply) {
+        constant *= inner_constant;
+        if (constant == 1) {
+            return std::move(*operand);
+        }
+    } else {
+        constant += inner_constant;
+        if (constant == 0) {
+            return std::move(*operand);
+        }
+    }
+
+    return make_binary(binary_expr.loc, std::move(*operand), constant, opcode);
+}
+
+// `x - x` is NaN rather than 0 when x is infinite or NaN, so this is only
+// done under FastMath.
+auto simplify_subtraction(BinaryExpression& binary_expr)
+    -> std::unique_ptr<Expression> {
+    if (same_value(*binary_expr.left, *binary_expr.right)) {
+        return std::make_unique<NumberLiteral>(binary_expr.loc, 0);
+    }
+
+    return reassociate(binary_expr);
+}
+
+// Dividing by a power of two is the same as multiplying by its reciprocal,
+// which is exact. The product is reassociated when `regroup` is set.
+auto reduce_reciprocal(BinaryExpression& binary_expr, bool regroup)
+    -> std::unique_ptr<Expression> {
+    auto const& rn = dynamic_cast<NumberLiteral*>(binary_expr.right.get());
+    int exponent = 0;
+
+    if (!rn || !std::isfinite(rn->value)
+        || std::abs(std::frexp(rn->value, &exponent)) != 0.5) {
+        return nullptr;
+    }
+
+    double reciprocal = 1 / rn->value;
+
+    if (!std::isnormal(reciprocal)) {
+        return nullptr;
+    }
+
+    auto product = make_binary(
+        binary_expr.loc,
+        std::move(binary_expr.left),
+        reciprocal,
+        Opcode::Multiply
+    );
+
+    if (!regroup) {
+        return product;
+    }
+
+    if (auto result =
+            reassociate(dynamic_cast<BinaryExpression&>(*product))) {
+        return result;
+    }
+
+    return product;
+}
+
 } // namespace dgeval::ast
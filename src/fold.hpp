@@ -4,10 +4,23 @@
 
 namespace dgeval::ast {
 
+class OptimizationFlags;
+
 class Fold: public Visitor<std::unique_ptr<Expression>> {
     std::vector<Message> errors;
+    std::unordered_map<std::string, Expression*> constants;
+    Opcode opcode {};
+    bool divisor {};
+    int conditional_depth {};
+    bool propagate;
+    bool simplify;
+    bool fast_math;
+    bool static_arrays;
 
   public:
+    Fold(OptimizationFlags flags);
+    [[nodiscard]] auto constant_array(Expression const& expression) const
+        -> ArrayLiteral const*;
     auto visit_program(Program& program)
         -> std::unique_ptr<Expression> override;
     auto visit_statement_list(StatementList& statements)
@@ -50,5 +63,27 @@ auto reduce_comparison(BinaryExpression& binary_expr)
     -> std::unique_ptr<Expression>;
 auto reduce_ternary(BinaryExpression& binary_expr)
     -> std::unique_ptr<Expression>;
+auto reduce_array_access(
+    BinaryExpression& binary_expr,
+    ArrayLiteral const& array
+) -> std::unique_ptr<Expression>;
+auto reduce_call(
+    BinaryExpression& binary_expr,
+    std::vector<Expression const*> const& arguments
+) -> std::unique_ptr<Expression>;
+auto reassociate(BinaryExpression& binary_expr)
+    -> std::unique_ptr<Expression>;
+auto simplify_subtraction(BinaryExpression& binary_expr)
+    -> std::unique_ptr<Expression>;
+auto reduce_reciprocal(BinaryExpression& binary_expr, bool regroup)
+    -> std::unique_ptr<Expression>;
+auto same_value(Expression const& a, Expression const& b) -> bool;
+auto is_constant(Expression const& expression) -> bool;
+void collect_items(
+    Expression const& items,
+    std::vector<Expression const*>& out
+);
+auto clone_constant(Expression const& constant, location loc)
+    -> std::unique_ptr<Expression>;
 
 } // namespace dgeval::ast
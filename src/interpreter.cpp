@@ -0,0 +1,552 @@
+#include "interpreter.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include "ast.hpp"
+
+using dgeval::ast::FunctionSignature;
+using dgeval::ast::NUMBER;
+using dgeval::ast::RUNTIME_LIBRARY;
+using dgeval::ast::STRING;
+
+using IntegralFunction = uint64_t(
+    uint64_t,
+    uint64_t,
+    uint64_t,
+    uint64_t,
+    double,
+    double,
+    double,
+    double
+);
+using NumberFunction = double(
+    uint64_t,
+    uint64_t,
+    uint64_t,
+    uint64_t,
+    double,
+    double,
+    double,
+    double
+);
+
+auto to_number(uint64_t value) -> double {
+    return std::bit_cast<double>(value);
+}
+
+auto from_number(double value) -> uint64_t {
+    return std::bit_cast<uint64_t>(value);
+}
+
+auto to_index(double value) -> int64_t {
+    value = std::nearbyint(value);
+
+    if (!(value >= -0x1p63 && value < 0x1p63)) {
+        return std::numeric_limits<int64_t>::min();
+    }
+
+    return static_cast<int64_t>(value);
+}
+
+Interpreter::Interpreter(Program& program) :
+    variable_count(program.variable_count()) {
+    operations.reserve(program.instructions.size() + 1);
+
+    for (auto const& instruction : program.instructions) {
+        decode(instruction);
+        stack_size =
+            std::max<size_t>(stack_size, instruction.stack_depth + 1);
+    }
+
+    operations.push_back({.handler = Handler::Halt});
+}
+
+void Interpreter::decode(Instruction const& instruction) {
+    Operation operation {.parameter = instruction.parameter};
+    auto const& value = instruction.value;
+
+    switch (instruction.opcode) {
+        case Opcode::Literal:
+            operation.handler = Handler::Push;
+            if (std::holds_alternative<double>(value)) {
+                operation.operand = from_number(get<double>(value));
+            } else if (std::holds_alternative<bool>(value)) {
+                operation.operand = static_cast<uint64_t>(get<bool>(value));
+            }
+            break;
+        case Opcode::Identifier:
+            operation.handler = Handler::Load;
+            break;
+        case Opcode::Assign:
+            operation.handler = Handler::Store;
+            break;
+        case Opcode::Pop:
+            operation.handler = Handler::Pop;
+            break;
+        case Opcode::Add:
+            operation.handler = Handler::Add;
+            break;
+        case Opcode::Subtract:
+            operation.handler = Handler::Subtract;
+            break;
+        case Opcode::Multiply:
+            operation.handler = Handler::Multiply;
+            break;
+        case Opcode::Divide:
+            operation.handler = Handler::Divide;
+            break;
+        case Opcode::Minus:
+            operation.handler = Handler::Minus;
+            break;
+        case Opcode::Not:
+            operation.handler = Handler::Not;
+            break;
+        case Opcode::And:
+            operation.handler = Handler::And;
+            break;
+        case Opcode::Or:
+            operation.handler = Handler::Or;
+            break;
+        case Opcode::Equal:
+        case Opcode::NotEqual:
+        case Opcode::Less:
+        case Opcode::LessEqual:
+        case Opcode::Greater:
+        case Opcode::GreaterEqual:
+            operation.handler = Handler::Compare;
+            operation.relation = instruction.opcode;
+            operation.number = true;
+            break;
+        case Opcode::EqualBoolean:
+            operation.handler = Handler::Compare;
+            operation.relation = Opcode::Equal;
+            break;
+        case Opcode::NotEqualBoolean:
+            operation.handler = Handler::Compare;
+            operation.relation = Opcode::NotEqual;
+            break;
+        case Opcode::Call:
+            operation.handler = Handler::Call;
+            operation.operand = std::bit_cast<uint64_t>(
+                &RUNTIME_LIBRARY.at(get<std::string>(value))
+            );
+            break;
+        case Opcode::Jump:
+            operation.handler = Handler::Jump;
+            break;
+        case Opcode::JumpFalse:
+            operation.handler = Handler::JumpFalse;
+            break;
+        case Opcode::JumpTrue:
+            operation.handler = Handler::JumpTrue;
+            break;
+        case Opcode::JumpEqual:
+        case Opcode::JumpNotEqual:
+        case Opcode::JumpLess:
+        case Opcode::JumpLessEqual:
+        case Opcode::JumpGreater:
+        case Opcode::JumpGreaterEqual:
+            operation.handler = Handler::JumpCompare;
+            operation.relation = static_cast<Opcode>(
+                std::to_underlying(instruction.opcode)
+                - std::to_underlying(Opcode::JumpEqual)
+                + std::to_underlying(Opcode::Equal)
+            );
+            operation.number = true;
+            break;
+        case Opcode::JumpEqualBoolean:
+            operation.handler = Handler::JumpCompare;
+            operation.relation = Opcode::Equal;
+            break;
+        case Opcode::JumpNotEqualBoolean:
+            operation.handler = Handler::JumpCompare;
+            operation.relation = Opcode::NotEqual;
+            break;
+        case Opcode::ArrayElement:
+            operation.handler = Handler::ArrayElement;
+            break;
+        case Opcode::Append:
+            operation.handler = Handler::AppendElement;
+            break;
+        case Opcode::Concat:
+            operation.handler = Handler::CatString;
+            break;
+        case Opcode::NumberToString:
+            operation.handler = Handler::NumberToString;
+            break;
+        case Opcode::CompareString:
+            operation.handler = Handler::StringCompare;
+            break;
+        case Opcode::CompareArray:
+            operation.handler = Handler::ArrayCompare;
+            break;
+        case Opcode::CallLRT:
+            switch (instruction.parameter) {
+                case 0:
+                    operation.handler = Handler::AllocateArray;
+                    operation.parameter = static_cast<int>(get<double>(value));
+                    operation.type = instruction.type;
+                    break;
+                case 3:
+                    operation.handler = Handler::PushString;
+                    operation.operand =
+                        std::bit_cast<uint64_t>(&get<std::string>(value));
+                    break;
+                case 8:
+                    operation.handler = Handler::Cleanup;
+                    break;
+                case 9:
+                    operation.handler = Handler::CopyArray;
+                    operation.type = instruction.type;
+                    operation.operand = std::bit_cast<uint64_t>(
+                        get<std::vector<uint64_t>>(value).data()
+                    );
+                    break;
+                default:
+                    break;
+            }
+            break;
+        default:
+            break;
+    }
+
+    operations.push_back(operation);
+}
+
+// Makes print calls append their argument to records instead of writing
+// it to the standard output.
+void Interpreter::record_prints(std::vector<PrintRecord>& records) {
+    auto const* print = &RUNTIME_LIBRARY.at("print");
+    printed = &records;
+
+    for (auto& operation : operations) {
+        if (operation.handler == Handler::Call
+            && std::bit_cast<FunctionSignature const*>(operation.operand)
+                == print) {
+            operation.handler = Handler::RecordPrint;
+        }
+    }
+}
+
+void Interpreter::run(lib::Runtime* runtime) const {
+    static void* const dispatch[] = {
+        &&nop,
+        &&push,
+        &&push_string,
+        &&load,
+        &&store,
+        &&pop,
+        &&add,
+        &&subtract,
+        &&multiply,
+        &&divide,
+        &&minus,
+        &&logical_not,
+        &&logical_and,
+        &&logical_or,
+        &&comparison,
+        &&call,
+        &&jump,
+        &&jump_false,
+        &&jump_true,
+        &&jump_compare,
+        &&allocate_array,
+        &&copy_array,
+        &&array_element,
+        &&append_element,
+        &&cat_string,
+        &&number_to_string,
+        &&string_compare,
+        &&array_compare,
+        &&record_print,
+        &&cleanup,
+        &&halt,
+    };
+
+    std::vector<uint64_t> variables(variable_count);
+    std::vector<uint64_t> stack(stack_size);
+    uint64_t* sp = stack.data() + stack.size();
+    Operation const* op = operations.data();
+
+    goto* dispatch[std::to_underlying(op->handler)];
+
+nop:
+    goto* dispatch[std::to_underlying((++op)->handler)];
+
+push:
+    *--sp = op->operand;
+    goto* dispatch[std::to_underlying((++op)->handler)];
+
+push_string:
+    *--sp = op->operand;
+    goto* dispatch[std::to_underlying((++op)->handler)];
+
+load:
+    *--sp = variables[op->parameter];
+    goto* dispatch[std::to_underlying((++op)->handler)];
+
+store:
+    variables[op->parameter] = sp[0];
+    goto* dispatch[std::to_underlying((++op)->handler)];
+
+pop:
+    sp += op->parameter;
+    goto* dispatch[std::to_underlying((++op)->handler)];
+
+add:
+    sp[1] = from_number(to_number(sp[1]) + to_number(sp[0]));
+    ++sp;
+    goto* dispatch[std::to_underlying((++op)->handler)];
+
+subtract:
+    sp[1] = from_number(to_number(sp[1]) - to_number(sp[0]));
+    ++sp;
+    goto* dispatch[std::to_underlying((++op)->handler)];
+
+multiply:
+    sp[1] = from_number(to_number(sp[1]) * to_number(sp[0]));
+    ++sp;
+    goto* dispatch[std::to_underlying((++op)->handler)];
+
+divide:
+    sp[1] = from_number(to_number(sp[1]) / to_number(sp[0]));
+    ++sp;
+    goto* dispatch[std::to_underlying((++op)->handler)];
+
+minus:
+    sp[0] ^= uint64_t {1} << 63;
+    goto* dispatch[std::to_underlying((++op)->handler)];
+
+logical_not:
+    sp[0] ^= 1;
+    goto* dispatch[std::to_underlying((++op)->handler)];
+
+logical_and:
+    sp[1] &= sp[0];
+    ++sp;
+    goto* dispatch[std::to_underlying((++op)->handler)];
+
+logical_or:
+    sp[1] |= sp[0];
+    ++sp;
+    goto* dispatch[std::to_underlying((++op)->handler)];
+
+comparison:
+    sp[1] = compare(op->relation, op->number, sp[1], sp[0]);
+    ++sp;
+    goto* dispatch[std::to_underlying((++op)->handler)];
+
+call: {
+    auto const& signature =
+        *std::bit_cast<FunctionSignature const*>(op->operand);
+    std::array<uint64_t, 4> integers {};
+    std::array<double, 4> numbers {};
+    size_t integer_count = 0;
+    size_t number_count = 0;
+
+    if (signature.return_type == STRING) {
+        integers[integer_count++] = std::bit_cast<uint64_t>(runtime);
+    }
+
+    for (size_t idx = 0; idx < signature.parameter_count; ++idx) {
+        uint64_t argument = sp[signature.parameter_count - 1 - idx];
+
+        if (signature.parameters[idx] == NUMBER) {
+            numbers[number_count++] = to_number(argument);
+        } else {
+            integers[integer_count++] = argument;
+        }
+    }
+
+    sp += signature.parameter_count;
+
+    if (signature.return_type == NUMBER) {
+        auto* function =
+            std::bit_cast<NumberFunction*>(signature.entry_point);
+        *--sp = from_number(function(
+            integers[0],
+            integers[1],
+            integers[2],
+            integers[3],
+            numbers[0],
+            numbers[1],
+            numbers[2],
+            numbers[3]
+        ));
+    } else {
+        auto* function =
+            std::bit_cast<IntegralFunction*>(signature.entry_point);
+        *--sp = function(
+            integers[0],
+            integers[1],
+            integers[2],
+            integers[3],
+            numbers[0],
+            numbers[1],
+            numbers[2],
+            numbers[3]
+        );
+    }
+    goto* dispatch[std::to_underlying((++op)->handler)];
+}
+
+jump:
+    op = operations.data() + op->parameter;
+    goto* dispatch[std::to_underlying(op->handler)];
+
+jump_false:
+    op = *sp++ == 0 ? operations.data() + op->parameter : op + 1;
+    goto* dispatch[std::to_underlying(op->handler)];
+
+jump_true:
+    op = *sp++ != 0 ? operations.data() + op->parameter : op + 1;
+    goto* dispatch[std::to_underlying(op->handler)];
+
+jump_compare: {
+    bool taken = compare(op->relation, op->number, sp[1], sp[0]);
+    sp += 2;
+    op = taken ? operations.data() + op->parameter : op + 1;
+    goto* dispatch[std::to_underlying(op->handler)];
+}
+
+allocate_array: {
+    auto* array = lib::Runtime::allocate_array(
+        runtime,
+        op->type,
+        op->parameter,
+        sp
+    );
+    sp += op->parameter;
+    *--sp = std::bit_cast<uint64_t>(array);
+    goto* dispatch[std::to_underlying((++op)->handler)];
+}
+
+copy_array:
+    *--sp = std::bit_cast<uint64_t>(lib::Runtime::copy_array(
+        runtime,
+        op->type,
+        std::bit_cast<uint64_t const*>(op->operand)
+    ));
+    goto* dispatch[std::to_underlying((++op)->handler)];
+
+array_element:
+    sp[1] = lib::Runtime::array_element(
+        runtime,
+        std::bit_cast<lib::Array*>(sp[1]),
+        to_index(to_number(sp[0]))
+    );
+    ++sp;
+
+    if (runtime->exception) {
+        lib::Runtime::post_exec_cleanup(runtime);
+        return;
+    }
+    goto* dispatch[std::to_underlying((++op)->handler)];
+
+append_element:
+    sp[1] = std::bit_cast<uint64_t>(lib::Runtime::append_element(
+        std::bit_cast<lib::Array*>(sp[1]),
+        sp[0]
+    ));
+    ++sp;
+    goto* dispatch[std::to_underlying((++op)->handler)];
+
+cat_string:
+    sp[1] = std::bit_cast<uint64_t>(lib::Runtime::cat_string(
+        runtime,
+        std::bit_cast<std::string*>(sp[1]),
+        std::bit_cast<std::string*>(sp[0])
+    ));
+    ++sp;
+    goto* dispatch[std::to_underlying((++op)->handler)];
+
+number_to_string:
+    sp[0] = std::bit_cast<uint64_t>(
+        lib::Runtime::number_to_string(runtime, to_number(sp[0]))
+    );
+    goto* dispatch[std::to_underlying((++op)->handler)];
+
+string_compare:
+    sp[1] = lib::Runtime::strcmp(
+        std::bit_cast<std::string*>(sp[1]),
+        std::bit_cast<std::string*>(sp[0]),
+        op->parameter
+    );
+    ++sp;
+    goto* dispatch[std::to_underlying((++op)->handler)];
+
+array_compare:
+    sp[1] = lib::Runtime::arrcmp(
+        std::bit_cast<lib::Array*>(sp[1]),
+        std::bit_cast<lib::Array*>(sp[0])
+    );
+    ++sp;
+    goto* dispatch[std::to_underlying((++op)->handler)];
+
+record_print: {
+    auto const* str = std::bit_cast<std::string const*>(sp[0]);
+    printed->push_back({static_cast<size_t>(op - operations.data()), *str});
+    sp[0] = from_number(static_cast<double>(str->length()));
+    goto* dispatch[std::to_underlying((++op)->handler)];
+}
+
+cleanup:
+    lib::Runtime::post_exec_cleanup(runtime);
+    goto* dispatch[std::to_underlying((++op)->handler)];
+
+halt:
+    return;
+}
+
+auto prefers_interpreter(Program const& program) -> bool {
+    return program.instructions.size() <= INTERPRETER_THRESHOLD;
+}
+
+auto compare(Opcode relation, bool number, uint64_t left, uint64_t right)
+    -> bool {
+    if (number) {
+        double a = to_number(left);
+        double b = to_number(right);
+        bool unordered = std::isnan(a) || std::isnan(b);
+
+        switch (relation) {
+            case Opcode::Equal:
+                return a == b || unordered;
+            case Opcode::NotEqual:
+                return a != b && !unordered;
+            case Opcode::Less:
+                return a < b || unordered;
+            case Opcode::LessEqual:
+                return a <= b || unordered;
+            case Opcode::Greater:
+                return a > b;
+            case Opcode::GreaterEqual:
+                return a >= b;
+            default:
+                return false;
+        }
+    }
+
+    auto a = std::bit_cast<int64_t>(left);
+    auto b = std::bit_cast<int64_t>(right);
+
+    switch (relation) {
+        case Opcode::Equal:
+            return a == b;
+        case Opcode::NotEqual:
+            return a != b;
+        case Opcode::Less:
+            return a < b;
+        case Opcode::LessEqual:
+            return a <= b;
+        case Opcode::Greater:
+            return a > b;
+        case Opcode::GreaterEqual:
+            return a >= b;
+        default:
+            return false;
+    }
+}
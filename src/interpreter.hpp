@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "context.hpp"
+#include "lang_runtime.hpp"
+
+using dgeval::ast::Instruction;
+using dgeval::ast::Opcode;
+using dgeval::ast::Program;
+
+inline constexpr size_t INTERPRETER_THRESHOLD = 1 << 20;
+
+enum class Handler : uint8_t {
+    Nop,
+    Push,
+    PushString,
+    Load,
+    Store,
+    Pop,
+    Add,
+    Subtract,
+    Multiply,
+    Divide,
+    Minus,
+    Not,
+    And,
+    Or,
+    Compare,
+    Call,
+    Jump,
+    JumpFalse,
+    JumpTrue,
+    JumpCompare,
+    AllocateArray,
+    CopyArray,
+    ArrayElement,
+    AppendElement,
+    CatString,
+    NumberToString,
+    StringCompare,
+    ArrayCompare,
+    RecordPrint,
+    Cleanup,
+    Halt,
+};
+
+struct Operation {
+    Handler handler {Handler::Nop};
+    Opcode relation {Opcode::None};
+    bool number {false};
+    TypeDescriptor type;
+    int parameter {};
+    uint64_t operand {};
+};
+
+// Text of a print call made while evaluating a module at compile time,
+// with the index of the instruction that made it.
+struct PrintRecord {
+    size_t instruction;
+    std::string text;
+};
+
+class Interpreter {
+  public:
+    Interpreter(Program& program);
+    void decode(Instruction const& instruction);
+    void record_prints(std::vector<PrintRecord>& records);
+    void run(lib::Runtime* runtime) const;
+
+    std::vector<Operation> operations;
+    std::vector<PrintRecord>* printed {nullptr};
+    size_t variable_count;
+    size_t stack_size {1};
+};
+
+auto prefers_interpreter(Program const& program) -> bool;
+auto compare(Opcode relation, bool number, uint64_t left, uint64_t right)
+    -> bool;
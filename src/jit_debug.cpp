@@ -0,0 +1,213 @@
+#include "jit_debug.hpp"
+#include <elf.h>
+#include <unistd.h>
+#include <array>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <mutex>
+
+extern "C" {
+enum jit_actions_t : uint32_t {
+    JIT_NOACTION = 0,
+    JIT_REGISTER_FN,
+    JIT_UNREGISTER_FN
+};
+
+struct jit_descriptor {
+    uint32_t version;
+    uint32_t action_flag;
+    jit_code_entry* relevant_entry;
+    jit_code_entry* first_entry;
+};
+
+[[gnu::noinline, gnu::used]] void __jit_debug_register_code() {
+    asm volatile("" ::: "memory");
+}
+
+[[gnu::used]] jit_descriptor __jit_debug_descriptor =
+    {1, JIT_NOACTION, nullptr, nullptr};
+}
+
+std::mutex jit_debug_mutex;
+
+enum Section : uint16_t {
+    Null,
+    Text,
+    Symtab,
+    Strtab,
+    Shstrtab,
+    SectionCount,
+};
+
+const char SECTION_NAMES[] = "\0.text\0.symtab\0.strtab\0.shstrtab";
+
+void append_bytes(
+    std::vector<uint8_t>& object,
+    void const* data,
+    size_t size
+) {
+    auto const* bytes = static_cast<uint8_t const*>(data);
+    object.insert(object.end(), bytes, bytes + size);
+}
+
+JitDebugInfo::JitDebugInfo(
+    std::string const& name,
+    uint8_t const* code,
+    size_t size,
+    std::vector<LineSymbol> const& symbols
+) :
+    name(name),
+    code(code),
+    size(size) {
+    write_perf_map(symbols);
+    build_object(symbols);
+    register_object();
+}
+
+JitDebugInfo::~JitDebugInfo() {
+    std::lock_guard lock(jit_debug_mutex);
+
+    if (entry.prev_entry) {
+        entry.prev_entry->next_entry = entry.next_entry;
+    } else {
+        __jit_debug_descriptor.first_entry = entry.next_entry;
+    }
+
+    if (entry.next_entry) {
+        entry.next_entry->prev_entry = entry.prev_entry;
+    }
+
+    __jit_debug_descriptor.relevant_entry = &entry;
+    __jit_debug_descriptor.action_flag = JIT_UNREGISTER_FN;
+    __jit_debug_register_code();
+}
+
+void JitDebugInfo::write_perf_map(
+    std::vector<LineSymbol> const& symbols
+) const {
+    std::ofstream map(
+        std::format("/tmp/perf-{}.map", getpid()),
+        std::ios::app
+    );
+
+    for (auto const& symbol : symbols) {
+        map << std::format(
+            "{:x} {:x} {}\n",
+            reinterpret_cast<uintptr_t>(code + symbol.offset),
+            symbol.size,
+            line_symbol_name(name, symbol)
+        );
+    }
+}
+
+void JitDebugInfo::build_object(std::vector<LineSymbol> const& symbols) {
+    std::string strtab(1, '\0');
+    std::vector<Elf64_Sym> symtab(1);
+
+    symtab.push_back(
+        {.st_name = static_cast<uint32_t>(strtab.size()),
+         .st_info = ELF64_ST_INFO(STB_LOCAL, STT_FILE),
+         .st_shndx = SHN_ABS}
+    );
+    strtab += name + '\0';
+
+    for (auto const& symbol : symbols) {
+        symtab.push_back(
+            {.st_name = static_cast<uint32_t>(strtab.size()),
+             .st_info = ELF64_ST_INFO(STB_GLOBAL, STT_FUNC),
+             .st_shndx = Section::Text,
+             .st_value = symbol.offset,
+             .st_size = symbol.size}
+        );
+        strtab += line_symbol_name(name, symbol) + '\0';
+    }
+
+    size_t symtab_offset =
+        sizeof(Elf64_Ehdr) + SectionCount * sizeof(Elf64_Shdr);
+    size_t symtab_size = symtab.size() * sizeof(Elf64_Sym);
+    size_t strtab_offset = symtab_offset + symtab_size;
+    size_t shstrtab_offset = strtab_offset + strtab.size();
+
+    Elf64_Ehdr header {
+        .e_type = ET_REL,
+        .e_machine = EM_X86_64,
+        .e_version = EV_CURRENT,
+        .e_shoff = sizeof(Elf64_Ehdr),
+        .e_ehsize = sizeof(Elf64_Ehdr),
+        .e_shentsize = sizeof(Elf64_Shdr),
+        .e_shnum = SectionCount,
+        .e_shstrndx = Section::Shstrtab,
+    };
+    std::memcpy(header.e_ident, ELFMAG, SELFMAG);
+    header.e_ident[EI_CLASS] = ELFCLASS64;
+    header.e_ident[EI_DATA] = ELFDATA2LSB;
+    header.e_ident[EI_VERSION] = EV_CURRENT;
+    header.e_ident[EI_OSABI] = ELFOSABI_SYSV;
+
+    std::array<Elf64_Shdr, SectionCount> sections {};
+    sections[Section::Text] = {
+        .sh_name = 1,
+        .sh_type = SHT_NOBITS,
+        .sh_flags = SHF_ALLOC | SHF_EXECINSTR,
+        .sh_addr = reinterpret_cast<uintptr_t>(code),
+        .sh_size = size,
+        .sh_addralign = 16,
+    };
+    sections[Section::Symtab] = {
+        .sh_name = 7,
+        .sh_type = SHT_SYMTAB,
+        .sh_offset = symtab_offset,
+        .sh_size = symtab_size,
+        .sh_link = Section::Strtab,
+        .sh_info = 2,
+        .sh_addralign = 8,
+        .sh_entsize = sizeof(Elf64_Sym),
+    };
+    sections[Section::Strtab] = {
+        .sh_name = 15,
+        .sh_type = SHT_STRTAB,
+        .sh_offset = strtab_offset,
+        .sh_size = strtab.size(),
+        .sh_addralign = 1,
+    };
+    sections[Section::Shstrtab] = {
+        .sh_name = 23,
+        .sh_type = SHT_STRTAB,
+        .sh_offset = shstrtab_offset,
+        .sh_size = sizeof(SECTION_NAMES),
+        .sh_addralign = 1,
+    };
+
+    append_bytes(object, &header, sizeof(header));
+    append_bytes(object, sections.data(), sizeof(sections));
+    append_bytes(object, symtab.data(), symtab_size);
+    append_bytes(object, strtab.data(), strtab.size());
+    append_bytes(object, SECTION_NAMES, sizeof(SECTION_NAMES));
+}
+
+void JitDebugInfo::register_object() {
+    entry.symfile_addr = reinterpret_cast<char const*>(object.data());
+    entry.symfile_size = object.size();
+
+    std::lock_guard lock(jit_debug_mutex);
+
+    entry.next_entry = __jit_debug_descriptor.first_entry;
+    if (entry.next_entry) {
+        entry.next_entry->prev_entry = &entry;
+    }
+
+    __jit_debug_descriptor.first_entry = &entry;
+    __jit_debug_descriptor.relevant_entry = &entry;
+    __jit_debug_descriptor.action_flag = JIT_REGISTER_FN;
+    __jit_debug_register_code();
+}
+
+auto line_symbol_name(std::string const& name, LineSymbol const& symbol)
+    -> std::string {
+    if (symbol.line == 0) {
+        return name;
+    }
+
+    return std::format("{}:{}", name, symbol.line);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "module.hpp"
+
+extern "C" {
+struct jit_code_entry {
+    jit_code_entry* next_entry;
+    jit_code_entry* prev_entry;
+    char const* symfile_addr;
+    uint64_t symfile_size;
+};
+}
+
+class JitDebugInfo {
+  public:
+    JitDebugInfo(
+        std::string const& name,
+        uint8_t const* code,
+        size_t size,
+        std::vector<LineSymbol> const& symbols
+    );
+    JitDebugInfo(JitDebugInfo const&) = delete;
+    auto operator=(JitDebugInfo const&) -> JitDebugInfo& = delete;
+    ~JitDebugInfo();
+
+    void write_perf_map(std::vector<LineSymbol> const& symbols) const;
+    void build_object(std::vector<LineSymbol> const& symbols);
+    void register_object();
+
+    std::string name;
+    uint8_t const* code;
+    size_t size;
+    std::vector<uint8_t> object;
+    jit_code_entry entry {};
+};
+
+auto line_symbol_name(std::string const& name, LineSymbol const& symbol)
+    -> std::string;
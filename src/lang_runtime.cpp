@@ -1,50 +1,86 @@
 #include "lang_runtime.hpp"
-#include <algorithm>
-#include <cmath>
-#include <numeric>
+#include <cstdlib>
+#include <cstring>
+#include <new>
 
 namespace lib {
 
-ArrayString::ArrayString(std::string** base, int count) : ArrayString() {
-    for (int idx = count - 1; idx >= 0; --idx) {
-        inner->push_back(base[idx]);
-    }
-}
+auto Array::create(TypeDescriptor item_type, int64_t capacity) -> Array* {
+    size_t size = item_type == BOOLEAN ? sizeof(uint8_t) : sizeof(uint64_t);
+    void* memory = std::malloc(sizeof(Array) + capacity * size);
+    auto* array = new (memory) Array {.type = item_type, .capacity = capacity};
+
+    array->data = array + 1;
 
-auto ArrayString::elements_equal(std::string* p1, std::string* p2) const
-    -> bool {
-    return *p1 == *p2;
+    return array;
 }
 
-ArrayDouble::ArrayDouble(double* base, int count) : ArrayDouble() {
-    for (int idx = count - 1; idx >= 0; --idx) {
-        inner->push_back(base[idx]);
+void Array::destroy(Array* array) {
+    if (!array->is_inline()) {
+        std::free(array->data);
     }
+
+    std::free(array);
 }
 
-auto ArrayDouble::elements_equal(double p1, double p2) const -> bool {
-    return p1 == p2;
+auto Array::item_size() const -> size_t {
+    return type == BOOLEAN ? sizeof(uint8_t) : sizeof(uint64_t);
 }
 
-ArrayBool::ArrayBool(int64_t* base, int count) : ArrayBool() {
-    for (int idx = count - 1; idx >= 0; --idx) {
-        inner->push_back(static_cast<bool>(base[idx]));
-    }
+auto Array::is_inline() const -> bool {
+    return data == this + 1;
 }
 
-auto ArrayBool::elements_equal(bool p1, bool p2) const -> bool {
-    return p1 == p2;
+void Array::reserve(int64_t new_capacity) {
+    if (new_capacity <= capacity) {
+        return;
+    }
+
+    if (is_inline()) {
+        void* buffer = std::malloc(new_capacity * item_size());
+        std::memcpy(buffer, data, length * item_size());
+        data = buffer;
+    } else {
+        data = std::realloc(data, new_capacity * item_size());
+    }
+
+    capacity = new_capacity;
 }
 
-ArrayArray::ArrayArray(TypeDescriptor type, ArrayArray** base, int count) :
-    ArrayArray(type) {
-    for (int idx = count - 1; idx >= 0; --idx) {
-        inner->push_back(base[idx]);
+void Array::append(uint64_t value) {
+    if (type == BOOLEAN) {
+        push_back(static_cast<uint8_t>(value != 0));
+    } else {
+        push_back(value);
     }
 }
 
-auto ArrayArray::elements_equal(ArrayArray* p1, ArrayArray* p2) const -> bool {
-    return p1->equals_to(p2);
+auto Array::equals_to(Array const* other) const -> bool {
+    if (length != other->length) {
+        return false;
+    }
+
+    for (int64_t idx = 0; idx < length; ++idx) {
+        bool equal = true;
+
+        if (type.is_array()) {
+            auto const* item = items<Array*>()[idx];
+            equal = item->equals_to(other->items<Array*>()[idx]);
+        } else if (type == STRING) {
+            equal = *items<std::string*>()[idx]
+                == *other->items<std::string*>()[idx];
+        } else if (type == NUMBER) {
+            equal = items<double>()[idx] == other->items<double>()[idx];
+        } else {
+            equal = items<uint8_t>()[idx] == other->items<uint8_t>()[idx];
+        }
+
+        if (!equal) {
+            return false;
+        }
+    }
+
+    return true;
 }
 
 void Runtime::register_array_object(Array* array) {
@@ -61,25 +97,10 @@ auto Runtime::allocate_array(
     int len,
     uint64_t* base
 ) -> Array* {
-    Array* array {};
-
-    if (type.dimension == 1) {
-        switch (type.type) {
-            case Type::Boolean:
-                array = new ArrayBool(std::bit_cast<int64_t*>(base), len);
-                break;
-            case Type::Number:
-                array = new ArrayDouble(std::bit_cast<double*>(base), len);
-                break;
-            case Type::String:
-                array =
-                    new ArrayString(std::bit_cast<std::string**>(base), len);
-                break;
-            default:
-                break;
-        }
-    } else {
-        array = new ArrayArray(type, std::bit_cast<ArrayArray**>(base), len);
+    Array* array = Array::create(type.item_type(), len);
+
+    for (int idx = len - 1; idx >= 0; --idx) {
+        array->append(base[idx]);
     }
 
     runtime->register_array_object(array);
@@ -87,96 +108,64 @@ auto Runtime::allocate_array(
     return array;
 }
 
-auto Runtime::array_element(Runtime* runtime, Array* array, int64_t index)
-    -> uint64_t {
-    if (array->type.is_array()) {
-        auto* array_array = dynamic_cast<ArrayArray*>(array);
+auto Runtime::copy_array(
+    Runtime* runtime,
+    TypeDescriptor type,
+    uint64_t const* data
+) -> Array* {
+    return read_array(runtime, type, data);
+}
 
-        runtime->exception = index < 0
-            || index >= static_cast<int64_t>(array_array->inner->size());
+auto Runtime::read_array(
+    Runtime* runtime,
+    TypeDescriptor type,
+    uint64_t const*& data
+) -> Array* {
+    auto len = static_cast<int64_t>(*data++);
+    Array* array = Array::create(type.item_type(), len);
 
-        if (!runtime->exception) {
-            return std::bit_cast<uint64_t>((*array_array->inner)[index]);
+    if (type.dimension == 1 && type.type == Type::Boolean) {
+        for (int64_t idx = 0; idx < len; ++idx) {
+            array->append(data[idx]);
         }
+
+        data += len;
+    } else if (type.dimension == 1) {
+        std::memcpy(array->data, data, len * sizeof(uint64_t));
+        array->length = len;
+        data += len;
     } else {
-        switch (array->type.type) {
-            case Type::Boolean: {
-                auto* bool_array = dynamic_cast<ArrayBool*>(array);
-
-                runtime->exception = index < 0
-                    || index >= static_cast<int64_t>(bool_array->inner->size());
-
-                if (!runtime->exception) {
-                    return static_cast<uint64_t>((*bool_array->inner)[index]);
-                }
-            } break;
-            case Type::String: {
-                auto* string_array = dynamic_cast<ArrayString*>(array);
-
-                runtime->exception = index < 0
-                    || index
-                        >= static_cast<int64_t>(string_array->inner->size());
-
-                if (!runtime->exception) {
-                    return std::bit_cast<uint64_t>(
-                        (*string_array->inner)[index]
-                    );
-                }
-            } break;
-            case Type::Number: {
-                auto* double_array = dynamic_cast<ArrayDouble*>(array);
-
-                runtime->exception = index < 0
-                    || index
-                        >= static_cast<int64_t>(double_array->inner->size());
-
-                if (!runtime->exception) {
-                    return std::bit_cast<uint64_t>(
-                        (*double_array->inner)[index]
-                    );
-                }
-            } break;
-            default:
-                break;
+        for (int64_t idx = 0; idx < len; ++idx) {
+            array->append(std::bit_cast<uint64_t>(
+                read_array(runtime, type.item_type(), data)
+            ));
         }
     }
 
-    return 0;
+    runtime->register_array_object(array);
+
+    return array;
 }
 
-auto Runtime::append_element(Array* array, uint64_t value) -> Array* {
-    if (array->type.is_array()) {
-        (dynamic_cast<ArrayArray*>(array))
-            ->inner->push_back(std::bit_cast<ArrayArray*>(value));
-    } else {
-        switch (array->type.type) {
-            case Type::Boolean:
-                (dynamic_cast<ArrayBool*>(array))
-                    ->inner->push_back(static_cast<bool>(value));
-                break;
-            case Type::String:
-                (dynamic_cast<ArrayString*>(array))
-                    ->inner->push_back(std::bit_cast<std::string*>(value));
-                break;
-            case Type::Number: {
-                double number = *std::bit_cast<double*>(&value);
-                (dynamic_cast<ArrayDouble*>(array))->inner->push_back(number);
-            } break;
-            default:
-                break;
-        }
+auto Runtime::array_element(Runtime* runtime, Array* array, int64_t index)
+    -> uint64_t {
+    runtime->exception = index < 0 || index >= array->length;
+
+    if (runtime->exception) {
+        return 0;
     }
 
-    return array;
-}
+    if (array->type == BOOLEAN) {
+        return array->items<uint8_t>()[index];
+    }
 
-auto Runtime::allocate_string(Runtime* runtime, std::string* str)
-    -> std::string* {
-    auto* p = new std::string(*str);
+    return array->items<uint64_t>()[index];
+}
 
-    runtime->register_string_object(p);
+auto Runtime::append_element(Array* array, uint64_t value) -> Array* {
+    array->append(value);
 
-    return p;
+    return array;
 }
 
 auto Runtime::cat_string(Runtime* runtime, std::string* s1, std::string* s2)
@@ -220,7 +209,7 @@ auto Runtime::strcmp(std::string* s1, std::string* s2, int64_t comparison)
 }
 
 auto Runtime::arrcmp(Array* arr1, Array* arr2) -> int64_t {
-    return arr1->_equals_to(arr2);
+    return arr1->equals_to(arr2);
 }
 
 auto Runtime::post_exec_cleanup(Runtime* runtime) -> int64_t {
@@ -229,7 +218,7 @@ auto Runtime::post_exec_cleanup(Runtime* runtime) -> int64_t {
     }
 
     for (auto* arr : runtime->arrays) {
-        delete (arr);
+        Array::destroy(arr);
     }
 
     return true;
@@ -239,48 +228,4 @@ auto Runtime::check_exception(Runtime* runtime) -> int64_t {
     return runtime->exception;
 }
 
-auto ArrayDouble::stddev() -> double {
-    size_t len = inner->size();
-
-    if (len == 0) {
-        return 0;
-    }
-
-    double sumx = 0;
-    double sumx2 = 0;
-
-    for (auto number : *inner) {
-        sumx += number;
-        sumx2 += number * number;
-    }
-
-    double mean = sumx / len;
-    double variance = sumx2 / len - mean * mean;
-
-    return std::sqrt(variance);
-}
-
-auto ArrayDouble::mean() -> double {
-    size_t len = inner->size();
-
-    if (len == 0) {
-        return 0;
-    }
-
-    double sum = std::reduce(inner->begin(), inner->end());
-    return sum / len;
-}
-
-auto ArrayDouble::count() -> double {
-    return inner->size();
-}
-
-auto ArrayDouble::min() -> double {
-    return *std::min_element(inner->begin(), inner->end());
-}
-
-auto ArrayDouble::max() -> double {
-    return *std::max_element(inner->begin(), inner->end());
-}
-
 } // namespace lib
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include "ast.hpp"
@@ -12,95 +14,49 @@ using dgeval::ast::TypeDescriptor;
 
 namespace lib {
 
+// An array is a single allocation holding this header followed by room for
+// capacity items. The header is tagged with the item type. Appending past
+// the capacity moves the items to a separate buffer, so the array keeps its
+// address while every alias sees the new item.
 class Array {
   public:
-    Array(TypeDescriptor type) : type(type) {}
+    static auto create(TypeDescriptor item_type, int64_t capacity) -> Array*;
+    static void destroy(Array* array);
 
-    virtual ~Array() = default;
-
-    virtual auto _equals_to(Array* other) -> bool = 0;
-
-    TypeDescriptor type;
-};
-
-template<typename T>
-class ArrayType: public Array {
-  public:
-    ArrayType(TypeDescriptor type) : Array(type), inner(new std::vector<T>) {}
-
-    ~ArrayType() override {
-        delete inner;
-    }
-
-    [[nodiscard]] virtual auto elements_equal(T p1, T p2) const -> bool = 0;
-
-    auto _equals_to(Array* other) -> bool override {
-        return equals_to(dynamic_cast<ArrayType<T>*>(other));
+    template<typename T>
+    [[nodiscard]] auto items() const -> T* {
+        return static_cast<T*>(data);
     }
 
-    [[nodiscard]] virtual auto equals_to(ArrayType<T>* other) const -> bool {
-        int len = inner->size();
-        std::vector<T>* other_array = other->inner;
-
-        if (len != other_array->size()) {
-            return false;
-        }
-
-        for (size_t idx = 0; idx < len; ++idx) {
-            if (!elements_equal((*inner)[idx], (*other_array)[idx])) {
-                return false;
-            }
+    template<typename T>
+    void push_back(T value) {
+        if (length == capacity) {
+            reserve(std::max<int64_t>(capacity * 2, 4));
         }
 
-        return true;
+        items<T>()[length++] = value;
     }
 
-    std::vector<T>* inner;
-};
-
-class ArrayString: public ArrayType<std::string*> {
-  public:
-    ArrayString() : ArrayType<std::string*>(STRING) {}
+    [[nodiscard]] auto item_size() const -> size_t;
+    [[nodiscard]] auto is_inline() const -> bool;
+    void reserve(int64_t new_capacity);
+    void append(uint64_t value);
+    [[nodiscard]] auto equals_to(Array const* other) const -> bool;
 
-    ArrayString(std::string** base, int count);
-
-    [[nodiscard]] auto elements_equal(std::string* p1, std::string* p2) const
-        -> bool override;
+    TypeDescriptor type;
+    int64_t length {0};
+    int64_t capacity {0};
+    void* data {nullptr};
 };
 
-class ArrayDouble: public ArrayType<double> {
-  public:
-    ArrayDouble() : ArrayType<double>(NUMBER) {}
-
-    ArrayDouble(double* base, int count);
-
-    [[nodiscard]] auto elements_equal(double p1, double p2) const
-        -> bool override;
-
-    auto stddev() -> double;
-    auto mean() -> double;
-    auto count() -> double;
-    auto min() -> double;
-    auto max() -> double;
+struct ProfileCounter {
+    uint64_t count;
+    uint64_t cycles;
 };
 
-class ArrayBool: public ArrayType<bool> {
-  public:
-    ArrayBool() : ArrayType<bool>(BOOLEAN) {}
-
-    ArrayBool(int64_t* base, int count);
-
-    [[nodiscard]] auto elements_equal(bool p1, bool p2) const -> bool override;
-};
-
-class ArrayArray: public ArrayType<ArrayArray*> {
-  public:
-    ArrayArray(TypeDescriptor type) : ArrayType<ArrayArray*>(type) {}
-
-    ArrayArray(TypeDescriptor type, ArrayArray** base, int count);
-
-    [[nodiscard]] auto elements_equal(ArrayArray* p1, ArrayArray* p2) const
-        -> bool override;
+struct ProfileSite {
+    int line;
+    std::string callee;
 };
 
 class Runtime {
@@ -113,11 +69,15 @@ class Runtime {
         int len,
         uint64_t* base
     ) -> Array*;
+    static auto
+    copy_array(Runtime* runtime, TypeDescriptor type, uint64_t const* data)
+        -> Array*;
+    static auto
+    read_array(Runtime* runtime, TypeDescriptor type, uint64_t const*& data)
+        -> Array*;
     static auto array_element(Runtime* runtime, Array* array, int64_t index)
         -> uint64_t;
     static auto append_element(Array* array, uint64_t value) -> Array*;
-    static auto allocate_string(Runtime* runtime, std::string* str)
-        -> std::string*;
     static auto cat_string(Runtime* runtime, std::string* s1, std::string* s2)
         -> std::string*;
     static auto number_to_string(Runtime* runtime, double number)
@@ -130,7 +90,13 @@ class Runtime {
 
     std::vector<Array*> arrays;
     std::vector<std::string*> strings;
+    // String literals of the module, shared by every evaluation and never
+    // registered for cleanup.
+    std::string* literals {nullptr};
     bool exception {false};
+    ProfileCounter* profile {nullptr};
+    uint64_t statement_start {};
+    uint64_t call_start {};
 };
 
 } // namespace lib
@@ -1,12 +1,56 @@
 #include "linear_ir.hpp"
+#include <bit>
+#include <format>
 #include "context.hpp"
 #include "optimize.hpp"
 
 namespace dgeval::ast {
 
+auto Instruction::stack_effect() const -> int {
+    switch (opcode) {
+        case Opcode::Identifier:
+        case Opcode::Literal:
+            return 1;
+        case Opcode::Assign:
+        case Opcode::Minus:
+        case Opcode::Not:
+        case Opcode::Jump:
+        case Opcode::NumberToString:
+            return 0;
+        case Opcode::Call:
+            return 1 - parameter;
+        case Opcode::Pop:
+            return -parameter;
+        case Opcode::CallLRT:
+            switch (parameter) {
+                case 0:
+                    return 1 - static_cast<int>(get<double>(value));
+                case 3:
+                case 9:
+                    return 1;
+                case 8:
+                    return 0;
+                default:
+                    return -1;
+            }
+        case Opcode::JumpEqual:
+        case Opcode::JumpNotEqual:
+        case Opcode::JumpLess:
+        case Opcode::JumpLessEqual:
+        case Opcode::JumpGreater:
+        case Opcode::JumpGreaterEqual:
+        case Opcode::JumpEqualBoolean:
+        case Opcode::JumpNotEqualBoolean:
+            return -2;
+        default:
+            return -1;
+    }
+}
+
 LinearIR::LinearIR(OptimizationFlags flags) :
     skip_dead_statements(flags[Optimization::DeadStatement]),
-    skip_dead_parts(flags[Optimization::DeadExpressionPart]) {}
+    skip_dead_parts(flags[Optimization::DeadExpressionPart]),
+    fuse_branches(flags[Optimization::BranchFusion]) {}
 
 void LinearIR::visit_program(Program& program) {
     program.statements->accept(*this);
@@ -16,8 +60,13 @@ void LinearIR::visit_program(Program& program) {
 void LinearIR::visit_statement_list(StatementList& statements) {
     for (auto& statement : statements.inner) {
         if (!skip_dead_statements || statement->expression->is_effective()) {
+            size_t start = instructions.size();
             statement->accept(*this);
             push_pop(statement->expression->stack_load);
+
+            for (size_t idx = start; idx < instructions.size(); ++idx) {
+                instructions[idx].line_number = statement->line_number;
+            }
         }
     }
 
@@ -51,6 +100,12 @@ void LinearIR::visit_boolean(BooleanLiteral& boolean) {
 }
 
 void LinearIR::visit_array(ArrayLiteral& array) {
+    if (array.idNdx == 9) {
+        instructions.emplace_back(array);
+        instructions.back().value = constant_array_data(array);
+        return;
+    }
+
     switch_context(*array.items, true);
 
     instructions.emplace_back(array);
@@ -71,22 +126,24 @@ void LinearIR::visit_binary_expression(BinaryExpression& binary_expr) {
     auto& right = binary_expr.right;
     size_t start = instructions.size() - 1;
 
-    if (binary_expr.opcode != Opcode::Assign
-        && binary_expr.opcode != Opcode::Call) {
+    if (binary_expr.opcode == Opcode::Conditional) {
+        false_jumps.emplace_back();
+        branch(*left, false, false_jumps.back());
+    } else if (binary_expr.opcode != Opcode::Assign
+               && binary_expr.opcode != Opcode::Call) {
         left->accept(*this);
     }
 
-    if (left->opcode == Opcode::Comma && binary_expr.opcode != Opcode::Comma) {
+    if (left->opcode == Opcode::Comma && binary_expr.opcode != Opcode::Comma
+        && binary_expr.opcode != Opcode::Conditional) {
         push_pop(left->stack_load - 1);
         left->stack_load = 1;
     }
 
-    if (binary_expr.opcode == Opcode::Conditional) {
-        instructions.emplace_back(Opcode::JumpFalse, 0, NUMBER);
-
-    } else if (binary_expr.opcode == Opcode::Alt) {
+    if (binary_expr.opcode == Opcode::Alt) {
         instructions.emplace_back(Opcode::Jump, 0, NUMBER);
-        instructions[start].parameter = instructions.size();
+        patch_jumps(false_jumps.back());
+        false_jumps.pop_back();
         start = instructions.size() - 1;
     }
 
@@ -129,16 +186,9 @@ void LinearIR::visit_binary_expression(BinaryExpression& binary_expr) {
         binary_expr.idNdx,
         binary_expr.type_desc
     );
+    specialize(instructions.back(), binary_expr, left->type_desc);
 
     switch (binary_expr.opcode) {
-        case Opcode::CallLRT: {
-            auto& value = instructions.back().value;
-            if (binary_expr.idNdx == 6 || binary_expr.idNdx == 7) {
-                value = static_cast<double>(binary_expr.stack_load);
-            } else if (std::holds_alternative<std::monostate>(value)) {
-                value = 0.0;
-            }
-        } break;
         case Opcode::Assign: {
             auto const& id = dynamic_cast<Identifier*>(left.get())->id;
             instructions.back().value = id;
@@ -149,13 +199,6 @@ void LinearIR::visit_binary_expression(BinaryExpression& binary_expr) {
             instruction.value = id;
             instruction.parameter = RUNTIME_LIBRARY.at(id).parameter_count;
         } break;
-        case Opcode::LessEqual:
-        case Opcode::GreaterEqual:
-        case Opcode::Less:
-        case Opcode::Greater:
-        case Opcode::NotEqual:
-        case Opcode::Equal:
-            instructions.back().type = binary_expr.left->type_desc;
         default:
             break;
     }
@@ -169,10 +212,7 @@ void LinearIR::visit_unary_expression(UnaryExpression& unary_expr) {
         unary_expr.idNdx,
         unary_expr.type_desc
     );
-
-    if (unary_expr.opcode == Opcode::CallLRT) {
-        instructions.back().value = 0.0;
-    }
+    specialize(instructions.back(), unary_expr, unary_expr.left->type_desc);
 }
 
 void LinearIR::push_pop(int count) {
@@ -181,6 +221,123 @@ void LinearIR::push_pop(int count) {
     }
 }
 
+auto can_skip(Expression* expression) -> bool {
+    if (expression == nullptr) {
+        return true;
+    }
+
+    if (auto* binary = dynamic_cast<BinaryExpression*>(expression)) {
+        switch (binary->opcode) {
+            case Opcode::Assign:
+            case Opcode::Call:
+            case Opcode::Comma:
+                return false;
+            case Opcode::CallLRT:
+                // Element access can throw and an append mutates its array.
+                if (binary->idNdx == 1 || binary->idNdx == 2) {
+                    return false;
+                }
+                [[fallthrough]];
+            default:
+                return can_skip(binary->left.get())
+                    && can_skip(binary->right.get());
+        }
+    }
+
+    if (auto* unary = dynamic_cast<UnaryExpression*>(expression)) {
+        return can_skip(unary->left.get());
+    }
+
+    if (auto* array = dynamic_cast<ArrayLiteral*>(expression)) {
+        return can_skip(array->items.get());
+    }
+
+    return true;
+}
+
+void LinearIR::branch(
+    Expression& cond,
+    bool jump_if,
+    std::vector<size_t>& jumps
+) {
+    if (fuse_branches && fuse_branch(cond, jump_if, jumps)) {
+        return;
+    }
+
+    cond.accept(*this);
+
+    if (cond.opcode == Opcode::Comma) {
+        push_pop(cond.stack_load - 1);
+        cond.stack_load = 1;
+    }
+
+    instructions.emplace_back(
+        jump_if ? Opcode::JumpTrue : Opcode::JumpFalse,
+        0,
+        NUMBER
+    );
+    jumps.push_back(instructions.size() - 1);
+}
+
+auto LinearIR::fuse_branch(
+    Expression& cond,
+    bool jump_if,
+    std::vector<size_t>& jumps
+) -> bool {
+    if (cond.opcode == Opcode::Not) {
+        auto& unary = dynamic_cast<UnaryExpression&>(cond);
+        branch(*unary.left, !jump_if, jumps);
+        return true;
+    }
+
+    auto* binary = dynamic_cast<BinaryExpression*>(&cond);
+    if (binary == nullptr || binary->left->opcode == Opcode::Comma) {
+        return false;
+    }
+
+    if (cond.opcode == Opcode::And || cond.opcode == Opcode::Or) {
+        if (!can_skip(binary->right.get())) {
+            return false;
+        }
+
+        if ((cond.opcode == Opcode::And) != jump_if) {
+            branch(*binary->left, jump_if, jumps);
+            branch(*binary->right, jump_if, jumps);
+        } else {
+            std::vector<size_t> skip;
+            branch(*binary->left, !jump_if, skip);
+            branch(*binary->right, jump_if, jumps);
+            patch_jumps(skip);
+        }
+
+        return true;
+    }
+
+    if (cond.opcode < Opcode::Equal || cond.opcode > Opcode::GreaterEqual
+        || binary->right->opcode == Opcode::Comma) {
+        return false;
+    }
+
+    auto const& operand = binary->left->type_desc;
+
+    binary->left->accept(*this);
+    binary->right->accept(*this);
+    instructions.emplace_back(
+        fused_jump(typed_comparison(cond.opcode, operand), jump_if),
+        0,
+        operand
+    );
+    jumps.push_back(instructions.size() - 1);
+
+    return true;
+}
+
+void LinearIR::patch_jumps(std::vector<size_t> const& jumps) {
+    for (size_t idx : jumps) {
+        instructions[idx].parameter = static_cast<int>(instructions.size());
+    }
+}
+
 void LinearIR::switch_context(Expression& expression, bool context) {
     bool temp = in_context;
     in_context = context;
@@ -188,4 +345,146 @@ void LinearIR::switch_context(Expression& expression, bool context) {
     in_context = temp;
 }
 
+auto typed_comparison(Opcode relation, TypeDescriptor operand) -> Opcode {
+    if (operand != BOOLEAN) {
+        return relation;
+    }
+
+    return relation == Opcode::Equal ? Opcode::EqualBoolean
+                                     : Opcode::NotEqualBoolean;
+}
+
+auto fused_jump(Opcode comparison, bool jump_if) -> Opcode {
+    static constexpr std::array<Opcode, 6> NEGATED = {
+        Opcode::JumpNotEqual,
+        Opcode::JumpEqual,
+        Opcode::JumpGreaterEqual,
+        Opcode::JumpGreater,
+        Opcode::JumpLessEqual,
+        Opcode::JumpLess,
+    };
+
+    switch (comparison) {
+        case Opcode::EqualBoolean:
+            return jump_if ? Opcode::JumpEqualBoolean
+                           : Opcode::JumpNotEqualBoolean;
+        case Opcode::NotEqualBoolean:
+            return jump_if ? Opcode::JumpNotEqualBoolean
+                           : Opcode::JumpEqualBoolean;
+        default: {
+            int const idx = std::to_underlying(comparison)
+                - std::to_underlying(Opcode::Equal);
+            int const jump_base = std::to_underlying(Opcode::JumpEqual);
+
+            return jump_if ? static_cast<Opcode>(jump_base + idx)
+                           : NEGATED.at(idx);
+        }
+    }
+}
+
+// Picks the typed form of an operator from the types of its operands, so
+// that later passes and the backends dispatch on the opcode alone.
+void specialize(
+    Instruction& instruction,
+    Expression const& expression,
+    TypeDescriptor operand
+) {
+    static constexpr std::array<Opcode, 8> RUNTIME_OPERATIONS = {
+        Opcode::CallLRT,
+        Opcode::ArrayElement,
+        Opcode::Append,
+        Opcode::CallLRT,
+        Opcode::Concat,
+        Opcode::NumberToString,
+        Opcode::CompareString,
+        Opcode::CompareArray,
+    };
+
+    if (expression.opcode == Opcode::CallLRT) {
+        instruction.opcode = RUNTIME_OPERATIONS.at(expression.idNdx);
+
+        if (instruction.opcode == Opcode::CompareString
+            || instruction.opcode == Opcode::CompareArray) {
+            instruction.parameter = expression.stack_load;
+        } else if (instruction.opcode != Opcode::CallLRT) {
+            instruction.parameter = 0;
+        }
+    } else if (expression.opcode >= Opcode::Equal
+               && expression.opcode <= Opcode::GreaterEqual) {
+        instruction.opcode = typed_comparison(expression.opcode, operand);
+        instruction.type = operand;
+    }
+}
+
+// An array is encoded as its item count followed by its items, with nested
+// arrays encoded in place.
+auto encode_constant(Expression const& items, std::vector<uint64_t>& data)
+    -> uint64_t {
+    if (auto const& comma = dynamic_cast<BinaryExpression const*>(&items)) {
+        return encode_constant(*comma->left, data)
+            + encode_constant(*comma->right, data);
+    }
+
+    if (auto const& array = dynamic_cast<ArrayLiteral const*>(&items)) {
+        size_t start = data.size();
+        data.push_back(0);
+        data[start] = encode_constant(*array->items, data);
+        return 1;
+    }
+
+    if (auto const& number = dynamic_cast<NumberLiteral const*>(&items)) {
+        data.push_back(std::bit_cast<uint64_t>(number->value));
+    } else {
+        data.push_back(dynamic_cast<BooleanLiteral const&>(items).value);
+    }
+
+    return 1;
+}
+
+auto constant_array_data(ArrayLiteral const& array) -> std::vector<uint64_t> {
+    std::vector<uint64_t> data;
+    encode_constant(array, data);
+
+    return data;
+}
+
+void check_stack_depth(Program& program) {
+    auto& instructions = program.instructions;
+    std::vector<int> target_depths(instructions.size() + 1, -1);
+    Instruction const* deepest = nullptr;
+    int max_depth = 0;
+    int depth = 0;
+
+    for (size_t idx = 0; idx < instructions.size(); ++idx) {
+        auto& instruction = instructions[idx];
+
+        if (target_depths[idx] != -1) {
+            depth = target_depths[idx];
+        }
+
+        instruction.stack_depth = depth;
+        depth += instruction.stack_effect();
+
+        if (instruction.is_jump()) {
+            target_depths[instruction.parameter] = depth;
+        }
+
+        if (depth > max_depth) {
+            max_depth = depth;
+            deepest = &instruction;
+        }
+    }
+
+    if (max_depth > MAX_STACK_DEPTH) {
+        program.messages.emplace_back(
+            deepest->line_number,
+            std::format(
+                "Statement needs {} operand stack slots, more than the limit of {}",
+                max_depth,
+                MAX_STACK_DEPTH
+            )
+        );
+    }
+}
+
 } // namespace dgeval::ast
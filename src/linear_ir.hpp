@@ -8,6 +8,8 @@ namespace dgeval::ast {
 class OptimizationFlags;
 class Program;
 
+inline constexpr int MAX_STACK_DEPTH = 1 << 17;
+
 class Instruction {
   public:
     Instruction(TypeDescriptor type) : type(type), opcode(Opcode::Literal) {}
@@ -31,11 +33,33 @@ class Instruction {
             || opcode == Opcode::CallLRT && parameter == 3;
     };
 
+    [[nodiscard]] auto is_jump() const -> bool {
+        return opcode >= Opcode::Jump && opcode <= Opcode::JumpTrue
+            || opcode >= Opcode::JumpEqual && opcode <= Opcode::JumpGreaterEqual
+            || opcode >= Opcode::JumpEqualBoolean;
+    }
+
+    [[nodiscard]] auto is_comparison() const -> bool {
+        return opcode >= Opcode::Equal && opcode <= Opcode::GreaterEqual
+            || opcode == Opcode::EqualBoolean
+            || opcode == Opcode::NotEqualBoolean;
+    }
+
+    [[nodiscard]] auto stack_effect() const -> int;
+
     Opcode opcode {Opcode::None};
     int parameter {};
     int code_offset {};
+    int line_number {};
+    int stack_depth {};
     TypeDescriptor type;
-    std::variant<std::monostate, double, std::string, bool> value;
+    std::variant<
+        std::monostate,
+        double,
+        std::string,
+        bool,
+        std::vector<uint64_t>>
+        value;
 };
 
 class LinearIR: public Visitor<void> {
@@ -55,11 +79,29 @@ class LinearIR: public Visitor<void> {
     void visit_unary_expression(UnaryExpression& unary_expr) override;
     void push_pop(int count);
     void switch_context(Expression& expression, bool context);
+    void branch(Expression& cond, bool jump_if, std::vector<size_t>& jumps);
+    auto fuse_branch(Expression& cond, bool jump_if, std::vector<size_t>& jumps)
+        -> bool;
+    void patch_jumps(std::vector<size_t> const& jumps);
 
     std::vector<Instruction> instructions;
+    std::vector<std::vector<size_t>> false_jumps;
     bool skip_dead_statements {true};
     bool skip_dead_parts {true};
+    bool fuse_branches {true};
     bool in_context {false};
 };
 
+auto typed_comparison(Opcode relation, TypeDescriptor operand) -> Opcode;
+auto fused_jump(Opcode comparison, bool jump_if) -> Opcode;
+void specialize(
+    Instruction& instruction,
+    Expression const& expression,
+    TypeDescriptor operand
+);
+auto encode_constant(Expression const& items, std::vector<uint64_t>& data)
+    -> uint64_t;
+auto constant_array_data(ArrayLiteral const& array) -> std::vector<uint64_t>;
+void check_stack_depth(Program& program);
+
 } // namespace dgeval::ast
@@ -0,0 +1,192 @@
+#include "liveness.hpp"
+#include "optimize.hpp"
+
+namespace dgeval::ast {
+
+Liveness::Liveness(OptimizationFlags flags) :
+    enabled(flags[Optimization::DeadStore]) {}
+
+void Liveness::visit_program(Program& program) {
+    if (!enabled) {
+        return;
+    }
+
+    program.statements->accept(*this);
+
+    auto live = live_statements();
+    std::vector<std::unique_ptr<Statement>> kept;
+    std::vector<std::unique_ptr<Statement>> dead;
+
+    for (size_t idx = 0; idx < live.size(); ++idx) {
+        auto& statement = program.statements->inner[idx];
+
+        if (live[idx]) {
+            kept.push_back(std::move(statement));
+        } else {
+            dead.push_back(std::move(statement));
+            uses[idx] = {};
+        }
+    }
+
+    program.statements = std::make_unique<StatementList>(std::move(kept));
+    program.dead_statements = std::make_unique<StatementList>(std::move(dead));
+
+    remove_unused_symbols(program);
+}
+
+void Liveness::visit_statement_list(StatementList& statements) {
+    for (auto& statement : statements.inner) {
+        if (!renumber) {
+            uses.emplace_back();
+        }
+
+        statement->accept(*this);
+    }
+}
+
+void Liveness::visit_expression_statement(ExpressionStatement& statement) {
+    statement.expression->accept(*this);
+}
+
+void Liveness::visit_wait_statement(WaitStatement& statement) {
+    if (!renumber) {
+        uses.back().reads.insert(
+            statement.id_list.begin(),
+            statement.id_list.end()
+        );
+    }
+
+    statement.expression->accept(*this);
+}
+
+void Liveness::visit_expression(Expression& expression) {}
+
+void Liveness::visit_number(NumberLiteral& number) {}
+
+void Liveness::visit_string(StringLiteral& string) {}
+
+void Liveness::visit_boolean(BooleanLiteral& boolean) {}
+
+void Liveness::visit_array(ArrayLiteral& array) {
+    opcode = Opcode::None;
+    array.items->accept(*this);
+}
+
+void Liveness::visit_identifier(Identifier& identifier) {
+    if (opcode == Opcode::Call || RUNTIME_LIBRARY.contains(identifier.id)) {
+        return;
+    }
+
+    if (renumber) {
+        if (opcode != Opcode::Assign) {
+            identifier.idNdx = renumber->at(identifier.id).idx;
+        }
+    } else if (opcode == Opcode::Assign) {
+        uses.back().defines.insert(identifier.id);
+    } else {
+        uses.back().reads.insert(identifier.id);
+    }
+}
+
+void Liveness::visit_binary_expression(BinaryExpression& binary_expr) {
+    switch (binary_expr.opcode) {
+        case Opcode::Assign:
+            if (renumber) {
+                auto const& left = dynamic_cast<Identifier&>(*binary_expr.left);
+                binary_expr.idNdx = renumber->at(left.id).idx;
+            }
+            break;
+        case Opcode::Call: {
+            auto const& id = dynamic_cast<Identifier&>(*binary_expr.left).id;
+            if (!renumber && !RUNTIME_LIBRARY.at(id).pure) {
+                uses.back().effects = true;
+            }
+        } break;
+        case Opcode::CallLRT:
+            // Element access can throw and appending modifies the array in
+            // place.
+            if (!renumber
+                && (binary_expr.idNdx == 1 || binary_expr.idNdx == 2)) {
+                uses.back().effects = true;
+            }
+            break;
+        default:
+            break;
+    }
+
+    opcode = binary_expr.opcode;
+    binary_expr.left->accept(*this);
+    opcode = Opcode::None;
+    if (binary_expr.right) {
+        binary_expr.right->accept(*this);
+    }
+}
+
+void Liveness::visit_unary_expression(UnaryExpression& unary_expr) {
+    opcode = Opcode::None;
+    unary_expr.left->accept(*this);
+}
+
+// A statement is live when it has an effect, is not an assignment or
+// defines a variable read by a live statement.
+auto Liveness::live_statements() const -> std::vector<bool> {
+    std::unordered_map<std::string, size_t> definitions;
+    std::vector<bool> live(uses.size());
+    std::vector<size_t> worklist;
+
+    for (size_t idx = 0; idx < uses.size(); ++idx) {
+        for (auto const& id : uses[idx].defines) {
+            definitions[id] = idx;
+        }
+
+        if (uses[idx].effects || uses[idx].defines.empty()) {
+            live[idx] = true;
+            worklist.push_back(idx);
+        }
+    }
+
+    while (!worklist.empty()) {
+        size_t idx = worklist.back();
+        worklist.pop_back();
+
+        for (auto const& id : uses[idx].reads) {
+            auto definition = definitions.find(id);
+
+            if (definition != definitions.end() && !live[definition->second]) {
+                live[definition->second] = true;
+                worklist.push_back(definition->second);
+            }
+        }
+    }
+
+    return live;
+}
+
+void Liveness::remove_unused_symbols(Program& program) {
+    std::unordered_set<std::string> referenced;
+
+    for (auto const& statement : uses) {
+        referenced.insert(statement.reads.begin(), statement.reads.end());
+        referenced.insert(statement.defines.begin(), statement.defines.end());
+    }
+
+    auto& symbols = program.symbol_table;
+    std::erase_if(symbols, [&](auto const& entry) {
+        return !referenced.contains(entry.first);
+    });
+
+    std::vector<SymbolDescriptor*> order;
+    for (auto& [id, symbol] : symbols) {
+        order.push_back(&symbol);
+    }
+
+    std::ranges::sort(order, {}, &SymbolDescriptor::idx);
+    for (size_t idx = 0; idx < order.size(); ++idx) {
+        order[idx]->idx = static_cast<int>(idx);
+    }
+
+    renumber = &symbols;
+    program.statements->accept(*this);
+}
+
+} // namespace dgeval::ast
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <unordered_set>
+#include "context.hpp"
+
+namespace dgeval::ast {
+
+class OptimizationFlags;
+
+struct StatementUses {
+    std::unordered_set<std::string> reads;
+    std::unordered_set<std::string> defines;
+    bool effects {false};
+};
+
+class Liveness: public Visitor<void> {
+    Opcode opcode;
+    std::vector<StatementUses> uses;
+    std::unordered_map<std::string, SymbolDescriptor>* renumber {nullptr};
+    bool enabled;
+
+  public:
+    Liveness(OptimizationFlags flags);
+    void visit_program(Program& program) override;
+    void visit_statement_list(StatementList& statements) override;
+    void visit_expression_statement(ExpressionStatement& statement) override;
+    void visit_wait_statement(WaitStatement& statement) override;
+    void visit_expression(Expression& expression) override;
+    void visit_number(NumberLiteral& number) override;
+    void visit_string(StringLiteral& string) override;
+    void visit_boolean(BooleanLiteral& boolean) override;
+    void visit_array(ArrayLiteral& array) override;
+    void visit_identifier(Identifier& identifier) override;
+    void visit_binary_expression(BinaryExpression& binary_expr) override;
+    void visit_unary_expression(UnaryExpression& unary_expr) override;
+    auto live_statements() const -> std::vector<bool>;
+    void remove_unused_symbols(Program& program);
+};
+
+} // namespace dgeval::ast
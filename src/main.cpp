@@ -1,26 +1,68 @@
 #include <charconv>
+#include <fstream>
+#include <optional>
 #include <print>
+#include <sstream>
 #include "checker.hpp"
 #include "codegen.hpp"
 #include "dependency.hpp"
 #include "driver.hpp"
+#include "evaluate.hpp"
 #include "fold.hpp"
+#include "interpreter.hpp"
+#include "jit_debug.hpp"
+#include "liveness.hpp"
+#include "module.hpp"
 #include "optimize.hpp"
 #include "printer.hpp"
+#include "promote.hpp"
+#include "value_numbering.hpp"
 
 auto main(int argc, char** argv) -> int {
-    if (argc != 2 && argc != 3) {
+    if (argc < 2) {
         std::println(
-            "Usage is {} <optional optimization parameter> <dgeval module file name",
+            "Usage is {} <optional optimization parameter> <optional -c> <optional -g> <optional -profile> <optional -interpret or -jit> <optional -emit-ir or -ir> <dgeval module file name",
             argv[0]
         );
         return 1;
     }
 
     dgeval::ast::OptimizationFlags optimization;
+    bool use_cache = false;
+    bool debug_info = false;
+    bool profile = false;
+    bool emit_ir = false;
+    bool load_ir = false;
+    std::optional<bool> interpret;
 
-    if (argc == 3) {
-        std::string flag = argv[1];
+    for (int idx = 1; idx < argc - 1; ++idx) {
+        std::string flag = argv[idx];
+
+        if (flag == "-c") {
+            use_cache = true;
+            continue;
+        }
+
+        if (flag == "-g") {
+            debug_info = true;
+            continue;
+        }
+
+        if (flag == "-profile") {
+            profile = true;
+            continue;
+        }
+
+        if (flag == "-emit-ir" || flag == "-ir") {
+            emit_ir = flag == "-emit-ir";
+            load_ir = flag == "-ir";
+            continue;
+        }
+
+        if (flag == "-interpret" || flag == "-jit") {
+            interpret = flag == "-interpret";
+            continue;
+        }
 
         if (flag.length() <= 2 || !flag.starts_with("-p")) {
             std::println("Invalid optimization flag.");
@@ -39,9 +81,12 @@ auto main(int argc, char** argv) -> int {
             return 1;
         }
 
-        if (parameter < 0 || parameter > 0b1111) {
+        int max_parameter = (1 << dgeval::ast::OPTIMIZATION_COUNT) - 1;
+
+        if (parameter < 0 || parameter > max_parameter) {
             std::println(
-                "Invalid optimization value after -p. It must be between 0 and 15."
+                "Invalid optimization value after -p. It must be between 0 and {}.",
+                max_parameter
             );
             return 1;
         }
@@ -50,13 +95,80 @@ auto main(int argc, char** argv) -> int {
     }
 
     std::string file_name = std::string(argv[argc - 1]);
-    std::ifstream input(file_name + ".txt");
 
-    if (!input.is_open()) {
+    if (load_ir) {
+        auto program = read_ir(file_name + ".dgir", optimization);
+
+        if (!program) {
+            std::println("Invalid IR file!");
+            return 1;
+        }
+
+        Codegen codegen(optimization);
+        DynamicFunction* func = codegen.generate(*program);
+
+        if (!func) {
+            std::println("Could not allocate memory for the generated code.");
+            return 1;
+        }
+
+        std::optional<JitDebugInfo> jit_debug;
+        if (debug_info) {
+            jit_debug.emplace(
+                file_name,
+                codegen.arena.base,
+                codegen.code_len,
+                codegen.module.line_symbols
+            );
+        }
+
+        lib::Runtime runtime;
+        runtime.literals = codegen.module.literals.data();
+        func(&runtime);
+
+        return 0;
+    }
+
+    std::ifstream file(file_name + ".txt");
+
+    if (!file.is_open()) {
         std::println("File not found!");
         return 1;
     }
 
+    std::string source {std::istreambuf_iterator<char>(file), {}};
+    std::optional<ModuleCache> cache;
+
+    if (use_cache && !profile) {
+        cache.emplace(source, optimization);
+
+        if (auto module = cache->load()) {
+            CodeArena arena;
+
+            if (DynamicFunction* func = module->load(arena)) {
+                for (auto const& message : module->messages) {
+                    std::println("{}", message);
+                }
+
+                std::optional<JitDebugInfo> jit_debug;
+                if (debug_info) {
+                    jit_debug.emplace(
+                        file_name,
+                        arena.base,
+                        module->code.size(),
+                        module->line_symbols
+                    );
+                }
+
+                lib::Runtime runtime;
+                runtime.literals = module->literals.data();
+                func(&runtime);
+                return 0;
+            }
+        }
+    }
+
+    std::istringstream input(source);
     Driver driver;
     dgeval::ast::Printer printer(file_name);
     int res = driver.parse(input);
@@ -69,29 +181,103 @@ auto main(int argc, char** argv) -> int {
     }
 
     if (!driver.program->any_errors()) {
-        dgeval::ast::Fold folder;
+        dgeval::ast::Fold folder(optimization);
         driver.program->accept(folder);
         if (!driver.program->any_errors()) {
-            dgeval::ast::LinearIR ic(optimization);
-            driver.program->accept(ic);
+            dgeval::ast::Liveness liveness(optimization);
+            driver.program->accept(liveness);
+            dgeval::ast::Promotion promotion(optimization);
+            driver.program->accept(promotion);
+            if (optimization
+                    [dgeval::ast::Optimization::StaticSingleAssignment]) {
+                dgeval::ast::GraphBuilder builder(optimization);
+                driver.program->accept(builder);
+                if (optimization[dgeval::ast::Optimization::ValueNumbering]) {
+                    dgeval::ast::ValueNumbering numbering;
+                    numbering.run(*driver.program);
+                }
+                dgeval::ast::StackLowering lowering(optimization);
+                lowering.run(*driver.program);
+            } else {
+                dgeval::ast::LinearIR ic(optimization);
+                driver.program->accept(ic);
+            }
             dgeval::ast::Peephole peephole(
                 driver.program->instructions,
                 optimization
             );
             peephole.run();
-            print_ic(file_name + "-IC.txt", driver.program->instructions);
+            dgeval::ast::check_stack_depth(*driver.program);
+            dgeval::ast::PartialEvaluation evaluation(optimization);
+            evaluation.run(*driver.program);
+            print_ic(
+                file_name + "-IC.txt",
+                driver.program->instructions,
+                peephole.hits
+            );
+
+            if (emit_ir && !driver.program->any_errors()
+                && !write_ir(
+                    file_name + ".dgir",
+                    *driver.program,
+                    optimization
+                )) {
+                std::println("Could not write the IR file.");
+            }
         }
     }
 
     driver.program->messages.emplace_back("Completed compilation");
     driver.program->accept(printer);
 
-    if (!driver.program->any_errors()) {
-        Codegen codegen;
+    if (!driver.program->any_errors()
+        && interpret.value_or(
+            !cache && !debug_info && !profile
+            && prefers_interpreter(*driver.program)
+        )) {
+        Interpreter interpreter(*driver.program);
+        lib::Runtime runtime;
+        interpreter.run(&runtime);
+    } else if (!driver.program->any_errors()) {
+        Codegen codegen(optimization);
+        codegen.profile = profile;
         DynamicFunction* func = codegen.generate(*driver.program);
 
+        if (func && cache) {
+            Module& module = codegen.relocatable();
+
+            for (auto const& message : driver.program->messages) {
+                module.messages.push_back(dgeval::ast::message_text(message));
+            }
+
+            cache->store(module);
+        }
+
+        std::optional<JitDebugInfo> jit_debug;
+        if (func && debug_info) {
+            jit_debug.emplace(
+                file_name,
+                codegen.arena.base,
+                codegen.code_len,
+                codegen.module.line_symbols
+            );
+        }
+
         if (func) {
-            func();
+            lib::Runtime runtime;
+            std::vector<lib::ProfileCounter> counters(
+                codegen.profile_sites.size()
+            );
+
+            runtime.profile = counters.data();
+            runtime.literals = codegen.module.literals.data();
+            func(&runtime);
+
+            if (profile) {
+                printer.print_profile(codegen.profile_sites, counters);
+            }
+        } else {
+            std::println("Could not allocate memory for the generated code.");
         }
     }
 
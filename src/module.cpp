@@ -0,0 +1,979 @@
+#include "module.hpp"
+#include <unistd.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <ranges>
+#include <tuple>
+#include "ast.hpp"
+#include "context.hpp"
+#include "promote.hpp"
+
+using dgeval::ast::Instruction;
+using dgeval::ast::Opcode;
+using dgeval::ast::Program;
+using dgeval::ast::TypeDescriptor;
+
+const std::map<std::string, void*> RUNTIME_SYMBOLS = {
+    {"allocate_array", reinterpret_cast<void*>(lib::Runtime::allocate_array)},
+    {"copy_array", reinterpret_cast<void*>(lib::Runtime::copy_array)},
+    {"array_element", reinterpret_cast<void*>(lib::Runtime::array_element)},
+    {"append_element", reinterpret_cast<void*>(lib::Runtime::append_element)},
+    {"cat_string", reinterpret_cast<void*>(lib::Runtime::cat_string)},
+    {"number_to_string",
+     reinterpret_cast<void*>(lib::Runtime::number_to_string)},
+    {"strcmp", reinterpret_cast<void*>(lib::Runtime::strcmp)},
+    {"arrcmp", reinterpret_cast<void*>(lib::Runtime::arrcmp)},
+    {"post_exec_cleanup",
+     reinterpret_cast<void*>(lib::Runtime::post_exec_cleanup)},
+    {"check_exception", reinterpret_cast<void*>(lib::Runtime::check_exception)},
+};
+
+const std::array<char, 4> MODULE_MAGIC = {'D', 'G', 'V', 'M'};
+const std::array<char, 4> IR_MAGIC = {'D', 'G', 'V', 'I'};
+
+template<typename T>
+void write_value(std::ofstream& output, T const& value) {
+    output.write(reinterpret_cast<char const*>(&value), sizeof(value));
+}
+
+template<typename T>
+auto read_value(std::ifstream& input, T& value) -> bool {
+    return static_cast<bool>(
+        input.read(reinterpret_cast<char*>(&value), sizeof(value))
+    );
+}
+
+void write_string(std::ofstream& output, std::string const& str) {
+    write_value(output, static_cast<uint32_t>(str.size()));
+    output.write(str.data(), static_cast<std::streamsize>(str.size()));
+}
+
+// Bytes left in the file, so a size read from it is checked before anything
+// of that size is allocated.
+auto remaining(std::ifstream& input) -> uint64_t {
+    auto position = input.tellg();
+    input.seekg(0, std::ios::end);
+    auto end = input.tellg();
+    input.seekg(position);
+
+    return static_cast<uint64_t>(end - position);
+}
+
+auto read_string(std::ifstream& input, std::string& str) -> bool {
+    uint32_t size {};
+    if (!read_value(input, size) || size > remaining(input)) {
+        return false;
+    }
+
+    str.resize(size);
+    return static_cast<bool>(input.read(str.data(), size));
+}
+
+void write_type(std::ofstream& output, TypeDescriptor type) {
+    write_value(output, type.type);
+    write_value(output, static_cast<int32_t>(type.dimension));
+}
+
+auto read_type(std::ifstream& input, TypeDescriptor& type) -> bool {
+    int32_t dimension {};
+    if (!read_value(input, type.type) || !read_value(input, dimension)) {
+        return false;
+    }
+
+    type.dimension = dimension;
+    return std::to_underlying(type.type) < dgeval::ast::TYPE_STR.size()
+        && dimension >= 0;
+}
+
+auto fnv1a(uint64_t hash, void const* data, size_t size) -> uint64_t {
+    auto const* bytes = static_cast<uint8_t const*>(data);
+
+    for (size_t idx = 0; idx < size; ++idx) {
+        hash = (hash ^ bytes[idx]) * 0x100000001b3;
+    }
+
+    return hash;
+}
+
+void Module::add_relocation(uint32_t offset, std::string const& symbol) {
+    auto found = std::ranges::find(symbols, symbol);
+    auto idx = static_cast<uint32_t>(found - symbols.begin());
+
+    if (found == symbols.end()) {
+        symbols.push_back(symbol);
+    }
+
+    relocations.push_back({offset, idx});
+}
+
+auto Module::add_literal(std::string const& literal) -> uint32_t {
+    auto found = std::ranges::find(literals, literal);
+    auto idx = static_cast<uint32_t>(found - literals.begin());
+
+    if (found == literals.end()) {
+        literals.push_back(literal);
+    }
+
+    return idx;
+}
+
+auto Module::write(std::filesystem::path const& path) const -> bool {
+    std::ofstream output(path, std::ios::binary);
+
+    if (!output.is_open()) {
+        return false;
+    }
+
+    output.write(MODULE_MAGIC.data(), MODULE_MAGIC.size());
+    write_value(output, MODULE_FORMAT_VERSION);
+
+    write_value(output, static_cast<uint32_t>(code.size()));
+    output.write(
+        reinterpret_cast<char const*>(code.data()),
+        static_cast<std::streamsize>(code.size())
+    );
+
+    write_value(output, static_cast<uint32_t>(symbols.size()));
+    for (auto const& symbol : symbols) {
+        write_string(output, symbol);
+    }
+
+    write_value(output, static_cast<uint32_t>(relocations.size()));
+    for (auto const& relocation : relocations) {
+        write_value(output, relocation.offset);
+        write_value(output, relocation.symbol);
+    }
+
+    write_value(output, static_cast<uint32_t>(line_symbols.size()));
+    for (auto const& symbol : line_symbols) {
+        write_value(output, symbol);
+    }
+
+    write_value(output, static_cast<uint32_t>(literals.size()));
+    for (auto const& literal : literals) {
+        write_string(output, literal);
+    }
+
+    write_value(output, static_cast<uint32_t>(messages.size()));
+    for (auto const& message : messages) {
+        write_string(output, message);
+    }
+
+    return static_cast<bool>(output);
+}
+
+auto Module::read(std::filesystem::path const& path) -> std::optional<Module> {
+    std::ifstream input(path, std::ios::binary);
+    std::array<char, 4> magic {};
+    uint32_t version {};
+    uint32_t count {};
+    Module module;
+
+    if (!input.read(magic.data(), magic.size()) || magic != MODULE_MAGIC
+        || !read_value(input, version) || version != MODULE_FORMAT_VERSION
+        || !read_value(input, count) || count > remaining(input)) {
+        return std::nullopt;
+    }
+
+    module.code.resize(count);
+    if (!input.read(reinterpret_cast<char*>(module.code.data()), count)
+        || !read_value(input, count)
+        || count > remaining(input) / sizeof(uint32_t)) {
+        return std::nullopt;
+    }
+
+    module.symbols.resize(count);
+    for (auto& symbol : module.symbols) {
+        if (!read_string(input, symbol)) {
+            return std::nullopt;
+        }
+    }
+
+    if (!read_value(input, count)
+        || count > remaining(input) / sizeof(Relocation)) {
+        return std::nullopt;
+    }
+
+    module.relocations.resize(count);
+    for (auto& relocation : module.relocations) {
+        if (!read_value(input, relocation.offset)
+            || !read_value(input, relocation.symbol)
+            || relocation.symbol >= module.symbols.size()
+            || relocation.offset + sizeof(uint64_t) > module.code.size()) {
+            return std::nullopt;
+        }
+    }
+
+    if (!read_value(input, count)
+        || count > remaining(input) / sizeof(LineSymbol)) {
+        return std::nullopt;
+    }
+
+    module.line_symbols.resize(count);
+    for (auto& symbol : module.line_symbols) {
+        if (!read_value(input, symbol)
+            || symbol.offset > module.code.size()
+            || symbol.size > module.code.size() - symbol.offset) {
+            return std::nullopt;
+        }
+    }
+
+    if (!read_value(input, count)
+        || count > remaining(input) / sizeof(uint32_t)) {
+        return std::nullopt;
+    }
+
+    module.literals.resize(count);
+    for (auto& literal : module.literals) {
+        if (!read_string(input, literal)) {
+            return std::nullopt;
+        }
+    }
+
+    if (!read_value(input, count)
+        || count > remaining(input) / sizeof(uint32_t)) {
+        return std::nullopt;
+    }
+
+    module.messages.resize(count);
+    for (auto& message : module.messages) {
+        if (!read_string(input, message)) {
+            return std::nullopt;
+        }
+    }
+
+    return module;
+}
+
+auto Module::load(CodeArena& arena) const -> DynamicFunction* {
+    if (!arena.reserve(code.size())) {
+        return nullptr;
+    }
+
+    std::memcpy(arena.base, code.data(), code.size());
+
+    for (auto const& relocation : relocations) {
+        void* address = resolve_symbol(symbols[relocation.symbol]);
+
+        if (address == nullptr) {
+            return nullptr;
+        }
+
+        std::memcpy(arena.base + relocation.offset, &address, sizeof(address));
+    }
+
+    return std::bit_cast<DynamicFunction*>(arena.seal());
+}
+
+ModuleCache::ModuleCache(
+    std::string const& source,
+    dgeval::ast::OptimizationFlags flags
+) {
+    std::filesystem::path directory;
+
+    if (char const* dir = std::getenv("DGEVAL_CACHE_DIR")) {
+        directory = dir;
+    } else if (char const* dir = std::getenv("XDG_CACHE_HOME")) {
+        directory = std::filesystem::path(dir) / "dgeval";
+    } else if (char const* dir = std::getenv("HOME")) {
+        directory = std::filesystem::path(dir) / ".cache" / "dgeval";
+    } else {
+        return;
+    }
+
+    std::error_code error;
+    auto executable = std::filesystem::path("/proc/self/exe");
+    uint64_t executable_size = std::filesystem::file_size(executable, error);
+    auto executable_time =
+        std::filesystem::last_write_time(executable, error).time_since_epoch();
+    unsigned long flag_bits = flags.value();
+
+    uint64_t hash = 0xcbf29ce484222325;
+    hash = fnv1a(hash, &MODULE_FORMAT_VERSION, sizeof(MODULE_FORMAT_VERSION));
+    hash = fnv1a(hash, &flag_bits, sizeof(flag_bits));
+    hash = fnv1a(hash, &executable_size, sizeof(executable_size));
+    hash = fnv1a(hash, &executable_time, sizeof(executable_time));
+    hash = fnv1a(hash, source.data(), source.size());
+
+    path = directory / std::format("{:016x}.dgm", hash);
+}
+
+auto ModuleCache::load() const -> std::optional<Module> {
+    if (path.empty()) {
+        return std::nullopt;
+    }
+
+    return Module::read(path);
+}
+
+void ModuleCache::store(Module const& module) const {
+    std::error_code error;
+
+    if (path.empty()
+        || (!std::filesystem::create_directories(path.parent_path(), error)
+            && error)) {
+        return;
+    }
+
+    auto temporary = path;
+    temporary += std::format(".{}", getpid());
+
+    if (module.write(temporary)) {
+        std::filesystem::rename(temporary, path, error);
+    } else {
+        std::filesystem::remove(temporary, error);
+    }
+}
+
+auto write_ir(
+    std::filesystem::path const& path,
+    Program const& program,
+    dgeval::ast::OptimizationFlags flags
+) -> bool {
+    std::ofstream output(path, std::ios::binary);
+    std::map<std::string, uint32_t> strings;
+
+    if (!output.is_open()) {
+        return false;
+    }
+
+    for (auto const& instruction : program.instructions) {
+        if (auto const* str = std::get_if<std::string>(&instruction.value)) {
+            strings.try_emplace(*str, static_cast<uint32_t>(strings.size()));
+        }
+    }
+
+    output.write(IR_MAGIC.data(), IR_MAGIC.size());
+    write_value(output, IR_FORMAT_VERSION);
+    write_value(output, static_cast<uint32_t>(flags.value()));
+    write_value(output, static_cast<int32_t>(program.temporary_count));
+
+    write_value(output, static_cast<uint32_t>(program.symbol_table.size()));
+    for (auto const& [id, symbol] : program.symbol_table) {
+        write_string(output, id);
+        write_type(output, symbol.type_desc);
+        write_value(output, static_cast<int32_t>(symbol.idx));
+        write_value(output, static_cast<int32_t>(symbol.home));
+    }
+
+    std::vector<std::string const*> ordered(strings.size());
+    for (auto const& [str, idx] : strings) {
+        ordered[idx] = &str;
+    }
+
+    write_value(output, static_cast<uint32_t>(ordered.size()));
+    for (auto const* str : ordered) {
+        write_string(output, *str);
+    }
+
+    write_value(output, static_cast<uint32_t>(program.instructions.size()));
+    for (auto const& instruction : program.instructions) {
+        auto const& value = instruction.value;
+
+        write_value(output, instruction.opcode);
+        write_value(output, static_cast<uint8_t>(value.index()));
+        write_type(output, instruction.type);
+        write_value(output, static_cast<int32_t>(instruction.parameter));
+        write_value(output, static_cast<int32_t>(instruction.line_number));
+        write_value(output, static_cast<int32_t>(instruction.stack_depth));
+
+        if (auto const* number = std::get_if<double>(&value)) {
+            write_value(output, *number);
+        } else if (auto const* str = std::get_if<std::string>(&value)) {
+            write_value(output, strings.at(*str));
+        } else if (auto const* boolean = std::get_if<bool>(&value)) {
+            write_value(output, static_cast<uint8_t>(*boolean));
+        } else if (auto const* data =
+                       std::get_if<std::vector<uint64_t>>(&value)) {
+            write_value(output, static_cast<uint32_t>(data->size()));
+            output.write(
+                reinterpret_cast<char const*>(data->data()),
+                static_cast<std::streamsize>(data->size() * sizeof(uint64_t))
+            );
+        }
+    }
+
+    return static_cast<bool>(output);
+}
+
+// Checks that a constant array blob holds exactly one array of the given
+// type, as Runtime::read_array would walk it.
+auto valid_constant_data(
+    TypeDescriptor type,
+    std::vector<uint64_t> const& data,
+    size_t& pos
+) -> bool {
+    if (pos >= data.size() || type.dimension == 0) {
+        return false;
+    }
+
+    uint64_t len = data[pos++];
+
+    if (type.dimension == 1) {
+        if (len > data.size() - pos) {
+            return false;
+        }
+
+        pos += len;
+        return true;
+    }
+
+    for (uint64_t idx = 0; idx < len; ++idx) {
+        if (!valid_constant_data(type.item_type(), data, pos)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Rejects instructions that would make Codegen index out of range, since
+// the loader skips every check the front end would have made.
+auto valid_instruction(Instruction const& instruction, Program const& program)
+    -> bool {
+    auto const& value = instruction.value;
+    auto parameter = static_cast<size_t>(instruction.parameter);
+
+    if (instruction.opcode > Opcode::JumpNotEqualBoolean) {
+        return false;
+    }
+
+    if (instruction.is_jump()) {
+        return parameter < program.instructions.size();
+    }
+
+    switch (instruction.opcode) {
+        case Opcode::None:
+        case Opcode::Comma:
+        case Opcode::Conditional:
+        case Opcode::Alt:
+        case Opcode::ArrayAccess:
+        case Opcode::Phi:
+            return false;
+        case Opcode::Identifier:
+        case Opcode::Assign:
+            return parameter < program.variable_count();
+        case Opcode::Literal:
+            return std::holds_alternative<double>(value)
+                || std::holds_alternative<bool>(value);
+        case Opcode::Pop:
+            return instruction.parameter > 0;
+        case Opcode::Call: {
+            auto const* id = std::get_if<std::string>(&value);
+            auto function = id ? dgeval::ast::RUNTIME_LIBRARY.find(*id)
+                               : dgeval::ast::RUNTIME_LIBRARY.end();
+
+            // Codegen pops as many arguments as the function takes.
+            return function != dgeval::ast::RUNTIME_LIBRARY.end()
+                && parameter == function->second.parameter_count;
+        }
+        case Opcode::CallLRT:
+            switch (instruction.parameter) {
+                case 0: {
+                    auto const* count = std::get_if<double>(&value);
+                    return count && *count >= 0
+                        && *count <= dgeval::ast::MAX_STACK_DEPTH
+                        && *count == static_cast<int>(*count);
+                }
+                case 3:
+                    return std::holds_alternative<std::string>(value);
+                case 8:
+                    return true;
+                case 9: {
+                    size_t pos = 0;
+                    return std::holds_alternative<std::vector<uint64_t>>(value)
+                        && valid_constant_data(
+                               instruction.type,
+                               get<std::vector<uint64_t>>(value),
+                               pos
+                        )
+                        && pos == get<std::vector<uint64_t>>(value).size();
+                }
+                default:
+                    return false;
+            }
+        default:
+            return true;
+    }
+}
+
+// Operands an instruction takes from the stack.
+auto operand_count(Instruction const& instruction) -> int {
+    switch (instruction.opcode) {
+        case Opcode::Identifier:
+        case Opcode::Literal:
+        case Opcode::Jump:
+            return 0;
+        case Opcode::Assign:
+        case Opcode::Minus:
+        case Opcode::Not:
+        case Opcode::NumberToString:
+        case Opcode::JumpFalse:
+        case Opcode::JumpTrue:
+            return 1;
+        case Opcode::Call:
+        case Opcode::Pop:
+            return instruction.parameter;
+        case Opcode::CallLRT:
+            return instruction.parameter == 0
+                ? static_cast<int>(get<double>(instruction.value))
+                : 0;
+        default:
+            return 2;
+    }
+}
+
+// Checks the depths check_stack_depth assigned: every way into an
+// instruction must agree on its depth, and no instruction may take more
+// operands than the stack holds.
+auto consistent_stack(std::vector<Instruction> const& instructions) -> bool {
+    for (size_t idx = 0; idx < instructions.size(); ++idx) {
+        auto const& instruction = instructions[idx];
+        int depth = instruction.stack_depth + instruction.stack_effect();
+
+        if (instruction.stack_depth < operand_count(instruction)) {
+            return false;
+        }
+
+        if (instruction.is_jump()
+            && (static_cast<size_t>(instruction.parameter) <= idx
+                || instructions[instruction.parameter].stack_depth != depth)) {
+            return false;
+        }
+
+        if (instruction.opcode != Opcode::Jump && idx + 1 < instructions.size()
+            && instructions[idx + 1].stack_depth != depth) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Operand-type stacks, interned so that two stacks are equal exactly when
+// their indices are. Index 0 is the empty stack.
+class TypeStacks {
+  public:
+    auto push(int stack, TypeDescriptor type) -> int {
+        auto [entry, inserted] = interned.try_emplace(
+            {stack, std::to_underlying(type.type), type.dimension},
+            static_cast<int>(entries.size())
+        );
+
+        if (inserted) {
+            entries.emplace_back(stack, type);
+        }
+
+        return entry->second;
+    }
+
+    // Returns the stack below the top, or -1 when the stack is empty.
+    auto pop(int stack, TypeDescriptor& type) const -> int {
+        if (stack <= 0) {
+            return -1;
+        }
+
+        type = entries[stack].second;
+        return entries[stack].first;
+    }
+
+  private:
+    std::vector<std::pair<int, TypeDescriptor>> entries {{-1, {}}};
+    std::map<std::tuple<int, uint8_t, int>, int> interned;
+};
+
+// Applies an instruction to the operand types on the stack. Returns the
+// resulting stack, or -1 when the operands do not have the types the
+// checker requires.
+auto apply_types(
+    TypeStacks& stacks,
+    int stack,
+    Instruction const& instruction,
+    std::vector<std::optional<TypeDescriptor>>& variables
+) -> int {
+    using dgeval::ast::BOOLEAN;
+    using dgeval::ast::NUMBER;
+    using dgeval::ast::STRING;
+
+    auto pop = [&]() -> std::optional<TypeDescriptor> {
+        TypeDescriptor type;
+        stack = stacks.pop(stack, type);
+        return stack == -1 ? std::nullopt : std::optional(type);
+    };
+    auto pop_as = [&](TypeDescriptor expected) {
+        auto type = pop();
+        return type && *type == expected;
+    };
+    auto unary = [&](TypeDescriptor operand, TypeDescriptor result) {
+        return pop_as(operand) ? stacks.push(stack, result) : -1;
+    };
+    auto binary = [&](TypeDescriptor operand, TypeDescriptor result) {
+        return pop_as(operand) && pop_as(operand) ? stacks.push(stack, result)
+                                                  : -1;
+    };
+
+    switch (instruction.opcode) {
+        case Opcode::Identifier:
+        case Opcode::Assign: {
+            // A temporary takes the type of its first load or store.
+            auto& type = variables[instruction.parameter];
+            if (!type) {
+                type = instruction.type;
+            }
+
+            if (*type != instruction.type) {
+                return -1;
+            }
+
+            return instruction.opcode == Opcode::Identifier
+                ? stacks.push(stack, *type)
+                : unary(*type, *type);
+        }
+        case Opcode::Literal:
+            return stacks.push(
+                stack,
+                std::holds_alternative<double>(instruction.value) ? NUMBER
+                                                                  : BOOLEAN
+            );
+        case Opcode::Minus:
+            return unary(NUMBER, NUMBER);
+        case Opcode::Not:
+            return unary(BOOLEAN, BOOLEAN);
+        case Opcode::Add:
+        case Opcode::Subtract:
+        case Opcode::Multiply:
+        case Opcode::Divide:
+            return binary(NUMBER, NUMBER);
+        case Opcode::And:
+        case Opcode::Or:
+        case Opcode::EqualBoolean:
+        case Opcode::NotEqualBoolean:
+            return binary(BOOLEAN, BOOLEAN);
+        case Opcode::Equal:
+        case Opcode::NotEqual:
+        case Opcode::Less:
+        case Opcode::LessEqual:
+        case Opcode::Greater:
+        case Opcode::GreaterEqual:
+            return binary(NUMBER, BOOLEAN);
+        case Opcode::Jump:
+            return stack;
+        case Opcode::JumpFalse:
+        case Opcode::JumpTrue:
+            return pop_as(BOOLEAN) ? stack : -1;
+        case Opcode::JumpEqualBoolean:
+        case Opcode::JumpNotEqualBoolean:
+            return pop_as(BOOLEAN) && pop_as(BOOLEAN) ? stack : -1;
+        case Opcode::JumpEqual:
+        case Opcode::JumpNotEqual:
+        case Opcode::JumpLess:
+        case Opcode::JumpLessEqual:
+        case Opcode::JumpGreater:
+        case Opcode::JumpGreaterEqual:
+            return pop_as(NUMBER) && pop_as(NUMBER) ? stack : -1;
+        case Opcode::Call: {
+            auto const& function = dgeval::ast::RUNTIME_LIBRARY.at(
+                get<std::string>(instruction.value)
+            );
+
+            for (auto parameter : function.parameters | std::views::reverse) {
+                if (!pop_as(parameter)) {
+                    return -1;
+                }
+            }
+
+            return stacks.push(stack, function.return_type);
+        }
+        case Opcode::Pop:
+            for (int idx = 0; idx < instruction.parameter; ++idx) {
+                if (!pop()) {
+                    return -1;
+                }
+            }
+            return stack;
+        case Opcode::CallLRT:
+            switch (instruction.parameter) {
+                case 0:
+                    if (!instruction.type.is_array()) {
+                        return -1;
+                    }
+
+                    for (int idx = 0; idx < get<double>(instruction.value);
+                         ++idx) {
+                        if (!pop_as(instruction.type.item_type())) {
+                            return -1;
+                        }
+                    }
+                    return stacks.push(stack, instruction.type);
+                case 3:
+                    return stacks.push(stack, STRING);
+                case 9:
+                    return stacks.push(stack, instruction.type);
+                default:
+                    return stack;
+            }
+        case Opcode::ArrayElement: {
+            bool index = pop_as(NUMBER);
+            auto array = pop();
+
+            return index && array && array->is_array()
+                    && instruction.type == array->item_type()
+                ? stacks.push(stack, instruction.type)
+                : -1;
+        }
+        case Opcode::Append: {
+            auto item = pop();
+            auto array = pop();
+
+            return item && array && array->is_array()
+                    && *item == array->item_type()
+                ? stacks.push(stack, *array)
+                : -1;
+        }
+        case Opcode::Concat:
+            return binary(STRING, STRING);
+        case Opcode::NumberToString:
+            return unary(NUMBER, STRING);
+        case Opcode::CompareString:
+            return binary(STRING, BOOLEAN);
+        case Opcode::CompareArray: {
+            auto right = pop();
+            auto left = pop();
+
+            return right && left && left->is_array() && *left == *right
+                ? stacks.push(stack, BOOLEAN)
+                : -1;
+        }
+        default:
+            return -1;
+    }
+}
+
+// Replays the operand types the checker enforced on the source program.
+// Code after an unconditional jump that no jump reaches never runs and is
+// skipped.
+auto consistent_types(Program const& program) -> bool {
+    auto const& instructions = program.instructions;
+    std::vector<std::optional<TypeDescriptor>> variables(
+        program.variable_count()
+    );
+    std::vector<int> incoming(instructions.size(), -1);
+    TypeStacks stacks;
+    int stack = 0;
+
+    for (auto const& [id, symbol] : program.symbol_table) {
+        if (variables[symbol.idx]) {
+            return false;
+        }
+
+        variables[symbol.idx] = symbol.type_desc;
+    }
+
+    for (size_t idx = 0; idx < instructions.size(); ++idx) {
+        auto const& instruction = instructions[idx];
+
+        if (incoming[idx] != -1) {
+            if (stack != -1 && stack != incoming[idx]) {
+                return false;
+            }
+
+            stack = incoming[idx];
+        }
+
+        if (stack == -1) {
+            continue;
+        }
+
+        stack = apply_types(stacks, stack, instruction, variables);
+
+        if (stack == -1) {
+            return false;
+        }
+
+        if (instruction.is_jump()) {
+            auto& target = incoming[instruction.parameter];
+
+            if (target != -1 && target != stack) {
+                return false;
+            }
+
+            target = stack;
+
+            if (instruction.opcode == Opcode::Jump) {
+                stack = -1;
+            }
+        }
+    }
+
+    return true;
+}
+
+auto read_ir(
+    std::filesystem::path const& path,
+    dgeval::ast::OptimizationFlags& flags
+) -> std::unique_ptr<Program> {
+    std::ifstream input(path, std::ios::binary);
+    std::array<char, 4> magic {};
+    uint32_t version {};
+    uint32_t flag_bits {};
+    int32_t temporary_count {};
+    uint32_t count {};
+    auto program = std::make_unique<Program>(
+        std::make_unique<dgeval::ast::StatementList>()
+    );
+
+    if (!input.read(magic.data(), magic.size()) || magic != IR_MAGIC
+        || !read_value(input, version) || version != IR_FORMAT_VERSION
+        || !read_value(input, flag_bits) || !read_value(input, temporary_count)
+        || temporary_count < 0 || !read_value(input, count)) {
+        return nullptr;
+    }
+
+    program->temporary_count = temporary_count;
+
+    for (uint32_t idx = 0; idx < count; ++idx) {
+        std::string id;
+        dgeval::ast::SymbolDescriptor symbol;
+        int32_t home {};
+
+        if (!read_string(input, id) || !read_type(input, symbol.type_desc)
+            || !read_value(input, symbol.idx) || !read_value(input, home)
+            || symbol.idx < 0 || static_cast<uint32_t>(symbol.idx) >= count
+            || home < -1 || home >= dgeval::ast::PROMOTION_REGISTER_COUNT) {
+            return nullptr;
+        }
+
+        symbol.home = home;
+        program->symbol_table[id] = symbol;
+    }
+
+    if (program->symbol_table.size() != count || !read_value(input, count)
+        || count > remaining(input) / sizeof(uint32_t)) {
+        return nullptr;
+    }
+
+    std::vector<std::string> strings(count);
+    for (auto& str : strings) {
+        if (!read_string(input, str)) {
+            return nullptr;
+        }
+    }
+
+    // Every temporary is stored by at least one instruction, which also
+    // keeps the frame size Codegen derives from the count in range.
+    if (!read_value(input, count)
+        || static_cast<uint32_t>(temporary_count) > count) {
+        return nullptr;
+    }
+
+    auto& instructions = program->instructions;
+
+    for (uint32_t idx = 0; idx < count; ++idx) {
+        auto& instruction = instructions.emplace_back(Opcode::None, 0);
+        uint8_t tag {};
+
+        if (!read_value(input, instruction.opcode) || !read_value(input, tag)
+            || !read_type(input, instruction.type)
+            || !read_value(input, instruction.parameter)
+            || !read_value(input, instruction.line_number)
+            || !read_value(input, instruction.stack_depth)) {
+            return nullptr;
+        }
+
+        switch (tag) {
+            case 0:
+                break;
+            case 1: {
+                double number {};
+                if (!read_value(input, number)) {
+                    return nullptr;
+                }
+                instruction.value = number;
+            } break;
+            case 2: {
+                uint32_t str {};
+                if (!read_value(input, str) || str >= strings.size()) {
+                    return nullptr;
+                }
+                instruction.value = strings[str];
+            } break;
+            case 3: {
+                uint8_t boolean {};
+                if (!read_value(input, boolean)) {
+                    return nullptr;
+                }
+                instruction.value = boolean != 0;
+            } break;
+            case 4: {
+                uint32_t size {};
+                if (!read_value(input, size)
+                    || size > remaining(input) / sizeof(uint64_t)) {
+                    return nullptr;
+                }
+
+                std::vector<uint64_t> data(size);
+                if (!input.read(
+                        reinterpret_cast<char*>(data.data()),
+                        static_cast<std::streamsize>(size * sizeof(uint64_t))
+                    )) {
+                    return nullptr;
+                }
+                instruction.value = std::move(data);
+            } break;
+            default:
+                return nullptr;
+        }
+    }
+
+    for (auto const& instruction : instructions) {
+        if (!valid_instruction(instruction, *program)) {
+            return nullptr;
+        }
+    }
+
+    // The stored depths are not trusted; they are derived again the way
+    // the compiler does, which also enforces the depth limit.
+    dgeval::ast::check_stack_depth(*program);
+    if (program->any_errors() || !consistent_stack(instructions)
+        || !consistent_types(*program)) {
+        return nullptr;
+    }
+
+    flags = dgeval::ast::OptimizationFlags(static_cast<int>(flag_bits));
+    return program;
+}
+
+auto resolve_symbol(std::string const& name) -> void* {
+    if (auto symbol = RUNTIME_SYMBOLS.find(name);
+        symbol != RUNTIME_SYMBOLS.end()) {
+        return symbol->second;
+    }
+
+    if (auto function = dgeval::ast::RUNTIME_LIBRARY.find(name);
+        function != dgeval::ast::RUNTIME_LIBRARY.end()) {
+        return function->second.entry_point;
+    }
+
+    return nullptr;
+}
+
+auto symbol_name(void* address) -> std::string {
+    for (auto const& [name, symbol] : RUNTIME_SYMBOLS) {
+        if (symbol == address) {
+            return name;
+        }
+    }
+
+    for (auto const& [name, function] : dgeval::ast::RUNTIME_LIBRARY) {
+        if (function.entry_point == address) {
+            return name;
+        }
+    }
+
+    return {};
+}
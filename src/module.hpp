@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include "arena.hpp"
+#include "lang_runtime.hpp"
+#include "optimize.hpp"
+
+namespace dgeval::ast {
+class Program;
+}
+
+using DynamicFunction = void(lib::Runtime* runtime);
+
+inline constexpr uint32_t MODULE_FORMAT_VERSION = 4;
+inline constexpr uint32_t IR_FORMAT_VERSION = 1;
+
+struct Relocation {
+    uint32_t offset;
+    uint32_t symbol;
+};
+
+struct LineSymbol {
+    uint32_t offset;
+    uint32_t size;
+    int32_t line;
+};
+
+class Module {
+  public:
+    void add_relocation(uint32_t offset, std::string const& symbol);
+    auto add_literal(std::string const& literal) -> uint32_t;
+    auto write(std::filesystem::path const& path) const -> bool;
+    static auto read(std::filesystem::path const& path)
+        -> std::optional<Module>;
+    auto load(CodeArena& arena) const -> DynamicFunction*;
+
+    std::vector<uint8_t> code;
+    std::vector<std::string> symbols;
+    std::vector<Relocation> relocations;
+    std::vector<LineSymbol> line_symbols;
+    std::vector<std::string> literals;
+    std::vector<std::string> messages;
+};
+
+class ModuleCache {
+  public:
+    ModuleCache(
+        std::string const& source,
+        dgeval::ast::OptimizationFlags flags
+    );
+    [[nodiscard]] auto load() const -> std::optional<Module>;
+    void store(Module const& module) const;
+
+    std::filesystem::path path;
+};
+
+// An IR file holds a program after optimization and stack depth checks, so
+// that it can be handed to Codegen without the front end.
+auto write_ir(
+    std::filesystem::path const& path,
+    dgeval::ast::Program const& program,
+    dgeval::ast::OptimizationFlags flags
+) -> bool;
+auto read_ir(
+    std::filesystem::path const& path,
+    dgeval::ast::OptimizationFlags& flags
+) -> std::unique_ptr<dgeval::ast::Program>;
+auto resolve_symbol(std::string const& name) -> void*;
+auto symbol_name(void* address) -> std::string;
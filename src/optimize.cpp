@@ -4,98 +4,98 @@
 
 namespace dgeval::ast {
 
-Window::Window(Instruction* start, Instruction* end, int offset) :
-    inner({&start[0], &start[1], &start[2]}),
-    end(end),
-    root(start - 1),
-    offset(offset) {}
-
-auto Window::ineffective_store_load() -> bool {
-    if (inner[1]->opcode != Opcode::Pop) {
-        return false;
-    }
-
-    auto* const first = inner[0];
-    auto* const third = inner[2];
-
-    if (first->opcode == Opcode::Assign && third->opcode == Opcode::Identifier
-        && first->parameter == third->parameter) {
-        offset += 2;
-        inner[1]->opcode = Opcode::None;
-        inner[1] += 2;
-        inner[2]->opcode = Opcode::None;
-        inner[2] += 2;
-        return true;
+auto matches(Shape shape, Instruction const& instruction) -> bool {
+    switch (shape) {
+        case Shape::Constant:
+            return instruction.is_literal();
+        case Shape::Load:
+            return instruction.opcode == Opcode::Identifier;
+        case Shape::Store:
+            return instruction.opcode == Opcode::Assign;
+        case Shape::Pop:
+            return instruction.opcode == Opcode::Pop;
     }
 
     return false;
 }
 
-auto Window::constant_value_sink() -> bool {
-    if (inner[0]->is_literal() && inner[1]->opcode == Opcode::Pop) {
-        inner[0]->opcode = Opcode::None;
-
-        if (inner[1]->parameter == 1) {
-            inner[1]->opcode = Opcode::None;
-            shift(2);
-            offset += 2;
-        } else {
-            --inner[1]->parameter;
-            shift_at(0, -1);
-            shift_at(2, 1);
-            offset += 1;
-        }
+auto forward_store(std::span<Instruction* const> window) -> bool {
+    auto* const store = window[0];
+    auto* const pop = window[1];
+    auto* const load = window[2];
 
-        return true;
+    if (pop->parameter != 1 || store->parameter != load->parameter) {
+        return false;
     }
 
-    return false;
+    pop->opcode = Opcode::None;
+    load->opcode = Opcode::None;
+    return true;
 }
 
-auto Window::shift_at(size_t idx, int value) -> bool {
-    auto& inst = inner[idx];
-    bool shift_forward = value >= 0;
-
-    if (inst == end && shift_forward) {
-        return true;
-    }
+auto sink_push(std::span<Instruction* const> window) -> bool {
+    auto* const push = window[0];
+    auto* const pop = window[1];
 
-    inst += value;
+    push->opcode = Opcode::None;
 
-    while (inst != end && inst->opcode == Opcode::None) {
-        inst += shift_forward ? 1 : -1;
+    if (--pop->parameter == 0) {
+        pop->opcode = Opcode::None;
     }
 
-    return inst == end;
+    return true;
 }
 
-auto Window::shift(int value) -> bool {
-    shift_at(0, value);
-    shift_at(1, value);
-    shift_at(2, value);
-
-    return inner[0] == end || inner[1] == end || inner[2] == end;
+auto merge_pops(std::span<Instruction* const> window) -> bool {
+    window[0]->parameter += window[1]->parameter;
+    window[1]->opcode = Opcode::None;
+    return true;
 }
 
-[[nodiscard]] auto Window::last_idx() const -> size_t {
-    for (size_t idx = 0; idx < 3; ++idx) {
-        if (inner[idx] == end) {
-            return idx - 1;
-        }
-    }
-
-    return 2;
-}
+const std::array<PeepholeRule, 4> PEEPHOLE_RULES = {{
+    {"store-load forwarding",
+     Optimization::PeepholeOffload,
+     {Shape::Store, Shape::Pop, Shape::Load},
+     forward_store},
+    {"literal sinking",
+     Optimization::PeepholeConstsink,
+     {Shape::Constant, Shape::Pop},
+     sink_push},
+    {"redundant load",
+     Optimization::PeepholeConstsink,
+     {Shape::Load, Shape::Pop},
+     sink_push},
+    {"pop merging",
+     Optimization::PeepholeConstsink,
+     {Shape::Pop, Shape::Pop},
+     merge_pops},
+}};
 
 Peephole::Peephole(
     std::vector<Instruction>& instructions,
     OptimizationFlags flags
 ) :
     instructions(instructions),
-    optimize_offload(flags[Optimization::PeepholeOffload]),
-    optimize_const_sink(flags[Optimization::PeepholeConstsink]) {}
+    flags(flags) {}
 
 void Peephole::apply_removal() {
+    std::vector<int> new_index(instructions.size() + 1);
+    int kept = 0;
+
+    for (size_t idx = 0; idx < instructions.size(); ++idx) {
+        new_index[idx] = kept;
+        if (instructions[idx].opcode != Opcode::None) {
+            ++kept;
+        }
+    }
+    new_index.back() = kept;
+
+    for (auto& inst : instructions) {
+        if (inst.is_jump()) {
+            inst.parameter = new_index[inst.parameter];
+        }
+    }
+
     auto removal = std::remove_if(
         instructions.begin(),
         instructions.end(),
@@ -106,139 +106,227 @@ void Peephole::apply_removal() {
 }
 
 void Peephole::run() {
-    if (!(optimize_offload || optimize_const_sink) || instructions.size() < 2) {
+    bool offload = flags[Optimization::PeepholeOffload];
+    bool const_sink = flags[Optimization::PeepholeConstsink];
+    bool threading = flags[Optimization::JumpThreading];
+
+    if (!(offload || const_sink || threading) || instructions.size() < 2) {
         return;
     }
 
-    Window window(instructions.begin().base(), instructions.end().base(), 0);
-    run_helper(window);
+    if (threading) {
+        thread_jumps();
+    }
+
+    if (offload || const_sink) {
+        rewrite_blocks();
+    }
 
     apply_removal();
-}
 
-[[nodiscard]] auto Window::branches_end_with_literals() const -> bool {
-    size_t idx = true_branch->last_idx();
-    if (idx < 3) {
-        if (!true_branch->inner[idx]->is_literal()) {
-            return false;
+    // Removed instructions may have left jumps landing on other jumps.
+    if (threading) {
+        thread_jumps();
+
+        if (remove_fallthrough_jumps()) {
+            apply_removal();
         }
-    } else if (true_branch->true_branch
-               && !true_branch->branches_end_with_literals()) {
-        return false;
     }
+}
 
-    idx = false_branch->last_idx();
-    if (idx < 3) {
-        if (!false_branch->inner[idx]->is_literal()) {
-            return false;
+// Jumps only go forward, so walking backwards threads every jump to the end
+// of its chain in one pass.
+void Peephole::thread_jumps() {
+    for (size_t idx = instructions.size(); idx-- > 0;) {
+        auto& inst = instructions[idx];
+        auto target = static_cast<size_t>(inst.parameter);
+
+        if (inst.is_jump() && target > idx && target < instructions.size()
+            && instructions[target].opcode == Opcode::Jump) {
+            inst.parameter = instructions[target].parameter;
+            ++hits["jump threading"];
         }
-    } else if (false_branch->false_branch
-               && !false_branch->branches_end_with_literals()) {
-        return false;
     }
-
-    return true;
 }
 
-auto Window::remove_literals(int offset) const -> int {
-    int true_offset = 0;
-    int false_offset = 0;
-
-    size_t idx = true_branch->last_idx();
-    if (idx < 3) {
-        true_branch->inner[idx]->opcode = Opcode::None;
-        true_offset = 1;
-    } else if (true_branch->true_branch) {
-        true_offset = true_branch->remove_literals(offset);
+// Basic blocks start at jump targets and after jumps. Each instruction is
+// pushed once on the list of instructions kept in its block and removed
+// from it at most once, so the rules run in linear time.
+void Peephole::rewrite_blocks() {
+    size_t size = instructions.size();
+    std::vector<bool> leaders(size + 1);
+    std::vector<size_t> kept;
+    size_t leader = 0;
+
+    incoming.assign(size + 1, {});
+    entries.assign(size + 1, {false, -1, 0});
+    jump_tails.assign(size, -1);
+    jump_blocks.assign(size, 0);
+
+    for (size_t idx = 0; idx < size; ++idx) {
+        auto const& inst = instructions[idx];
+
+        if (inst.is_jump()) {
+            incoming[inst.parameter].push_back(idx);
+            leaders[inst.parameter] = true;
+            leaders[idx + 1] = true;
+        }
     }
-    true_branch->root->parameter -= true_offset + offset;
 
-    idx = false_branch->last_idx();
-    if (idx < 3) {
-        false_branch->inner[idx]->opcode = Opcode::None;
-        false_offset = 1;
-    } else if (false_branch->false_branch) {
-        false_offset = false_branch->remove_literals(offset + true_offset);
-    }
-    false_branch->root->parameter -= true_offset + false_offset + offset;
+    for (size_t idx = 0; idx < size; ++idx) {
+        auto& inst = instructions[idx];
+
+        if (idx != 0 && leaders[idx]) {
+            int tail = kept.empty() ? -1 : static_cast<int>(kept.back());
+            entries[idx] = {
+                tail == -1 || instructions[tail].opcode != Opcode::Jump,
+                tail,
+                leader
+            };
+            leader = idx;
+            kept.clear();
+        }
 
-    return true_offset + false_offset;
-}
+        if (inst.opcode == Opcode::None) {
+            continue;
+        }
+
+        if (inst.is_jump()) {
+            jump_tails[idx] = kept.empty() ? -1 : static_cast<int>(kept.back());
+            jump_blocks[idx] = leader;
+        }
+
+        if (kept.empty() && leader != 0 && inst.opcode == Opcode::Pop
+            && flags[Optimization::PeepholeConstsink]
+            && sink_into_join(leader, inst)) {
+            ++hits["join sinking"];
 
-void Peephole::run_helper(Window& window) {
-    while (true) {
-        if (window.last_idx() == 0) {
-            return;
+            if (inst.opcode == Opcode::None) {
+                continue;
+            }
         }
 
-        if (window.inner[0]->opcode == Opcode::JumpFalse) {
-            // this is so cursed
+        kept.push_back(idx);
+        apply_rules(kept);
+    }
+}
+
+void Peephole::apply_rules(std::vector<size_t>& kept) {
+    std::array<Instruction*, 3> window {};
+    bool matched = true;
 
-            auto* jmp = &instructions[window.inner[0]->parameter - 1];
-            auto* continuation = &instructions[jmp->parameter];
+    while (matched) {
+        matched = false;
 
-            window.true_branch =
-                std::make_unique<Window>(window.inner[1], jmp, window.offset);
-            run_helper(*window.true_branch);
+        for (auto const& rule : PEEPHOLE_RULES) {
+            size_t length = rule.pattern.size();
 
-            window.false_branch = std::make_unique<Window>(
-                jmp + 1,
-                continuation,
-                window.true_branch->offset
-            );
-            run_helper(*window.false_branch);
-
-            window.offset = window.false_branch->offset;
-
-            if (optimize_const_sink && continuation->opcode == Opcode::Pop
-                && follow_jumps(instructions, window.root) != continuation
-                && window.branches_end_with_literals()) {
-                window.offset += window.remove_literals(0) + 1;
-                if (continuation->parameter == 1) {
-                    continuation->opcode = Opcode::None;
-                } else {
-                    --continuation->parameter;
-                }
+            if (!flags[rule.flag] || kept.size() < length) {
+                continue;
             }
 
-            window.inner[0]->parameter -= window.true_branch->offset;
-            jmp->parameter -= window.false_branch->offset;
-            window.inner[0] = continuation;
-            window.inner[1] = continuation + 1;
-            window.inner[2] = continuation + 2;
+            size_t first = kept.size() - length;
+            bool fits = true;
 
-            if (follow_jumps(instructions, continuation)->opcode
-                != Opcode::Pop) {
-                window.true_branch.reset();
-                window.false_branch.reset();
+            for (size_t idx = 0; idx < length && fits; ++idx) {
+                window[idx] = &instructions[kept[first + idx]];
+                fits = matches(rule.pattern[idx], *window[idx]);
             }
-        }
 
-        if (optimize_offload && window.ineffective_store_load()) {
-            continue;
-        }
+            if (!fits || !rule.rewrite({window.data(), length})) {
+                continue;
+            }
 
-        if (optimize_const_sink && window.constant_value_sink()) {
-            continue;
+            ++hits[rule.name];
+            std::erase_if(
+                kept,
+                [&](size_t idx) {
+                    return instructions[idx].opcode == Opcode::None;
+                }
+            );
+            matched = true;
+            break;
         }
+    }
+}
 
-        if (window.shift(1)) {
-            if (window.constant_value_sink()) {
-                window.shift_at(0, -1);
-                window.end = window.inner[1];
-            }
-            break;
+// A conditional whose result is popped right after the join pushes a
+// constant on every incoming path. The pushes and one popped slot cancel.
+auto Peephole::sink_into_join(size_t leader, Instruction& pop) -> bool {
+    std::vector<size_t> producers;
+
+    if (!collect_producers(leader, producers)) {
+        return false;
+    }
+
+    for (auto producer : producers) {
+        instructions[producer].opcode = Opcode::None;
+    }
+
+    if (--pop.parameter == 0) {
+        pop.opcode = Opcode::None;
+    }
+
+    return true;
+}
+
+auto Peephole::collect_producers(
+    size_t leader,
+    std::vector<size_t>& producers
+) -> bool {
+    for (auto jump : incoming[leader]) {
+        if (instructions[jump].opcode != Opcode::Jump
+            || !add_producer(jump_tails[jump], jump_blocks[jump], producers)) {
+            return false;
         }
     }
+
+    auto const& entry = entries[leader];
+
+    if (entry.falls_through
+        && !add_producer(entry.tail, entry.previous, producers)) {
+        return false;
+    }
+
+    return !producers.empty();
 }
 
-auto follow_jumps(std::vector<Instruction>& instructions, Instruction* start)
-    -> Instruction* {
-    while (start->opcode == Opcode::Jump) {
-        start = &instructions[start->parameter];
+// A block that is empty up to its jump passes on the values of its own
+// predecessors.
+auto Peephole::add_producer(
+    int tail,
+    size_t leader,
+    std::vector<size_t>& producers
+) -> bool {
+    if (tail == -1) {
+        return leader != 0 && collect_producers(leader, producers);
+    }
+
+    auto const& inst = instructions[tail];
+
+    if (!matches(Shape::Constant, inst) && !matches(Shape::Load, inst)) {
+        return false;
+    }
+
+    producers.push_back(tail);
+    return true;
+}
+
+auto Peephole::remove_fallthrough_jumps() -> bool {
+    bool removed = false;
+
+    for (size_t idx = 0; idx < instructions.size(); ++idx) {
+        auto& inst = instructions[idx];
+
+        if (inst.opcode == Opcode::Jump
+            && static_cast<size_t>(inst.parameter) == idx + 1) {
+            inst.opcode = Opcode::None;
+            ++hits["fallthrough jump"];
+            removed = true;
+        }
     }
 
-    return start;
+    return removed;
 }
 
 } // namespace dgeval::ast
@@ -2,6 +2,9 @@
 
 #include <bitset>
 #include <cstdint>
+#include <map>
+#include <span>
+#include <string_view>
 #include <utility>
 #include "linear_ir.hpp"
 
@@ -14,13 +17,33 @@ enum class Optimization : std::uint8_t {
     DeadExpressionPart,
     PeepholeOffload,
     PeepholeConstsink,
+    RegisterStack,
+    VariablePromotion,
+    InlineArrayAccess,
+    BranchFusion,
+    ConstantOperands,
+    StaticSingleAssignment,
+    ValueNumbering,
+    ConstantPropagation,
+    JumpThreading,
+    AlgebraicSimplification,
+    StaticArrays,
+    DeadStore,
+    PartialEvaluation,
+    FastMath,
 };
 
+inline constexpr size_t OPTIMIZATION_COUNT = 18;
+
 class OptimizationFlags {
-    std::bitset<4> flags;
+    std::bitset<OPTIMIZATION_COUNT> flags;
 
   public:
-    OptimizationFlags() : flags(0b1111) {}
+    // Rewrites that can change floating-point results are only enabled on
+    // request.
+    OptimizationFlags() : flags((1 << OPTIMIZATION_COUNT) - 1) {
+        set(Optimization::FastMath, false);
+    }
 
     OptimizationFlags(int flags) : flags(flags) {}
 
@@ -31,40 +54,55 @@ class OptimizationFlags {
     constexpr auto operator[](Optimization flag) const -> bool {
         return flags[std::to_underlying(flag)];
     }
+
+    [[nodiscard]] auto value() const -> unsigned long {
+        return flags.to_ulong();
+    }
 };
 
-class Window {
-  public:
-    Window(Instruction* start, Instruction* end, int offset);
-    auto ineffective_store_load() -> bool;
-    auto constant_value_sink() -> bool;
-    auto shift_at(size_t idx, int value) -> bool;
-    auto shift(int value) -> bool;
-    [[nodiscard]] auto last_idx() const -> size_t;
-    [[nodiscard]] auto branches_end_with_literals() const -> bool;
-    [[nodiscard]] auto remove_literals(int offset) const -> int;
-
-    std::array<Instruction*, 3> inner;
-    Instruction* end;
-    Instruction* root;
-    std::unique_ptr<Window> true_branch;
-    std::unique_ptr<Window> false_branch;
-    int offset {0};
+enum class Shape : std::uint8_t { Constant, Load, Store, Pop };
+
+// A window rule matches the last instructions kept in a basic block against
+// its pattern and rewrites them in place, setting removed instructions to
+// Opcode::None. It returns false when the instructions fit the pattern but
+// not the rule.
+struct PeepholeRule {
+    std::string_view name;
+    Optimization flag;
+    std::vector<Shape> pattern;
+    auto (*rewrite)(std::span<Instruction* const> window) -> bool;
 };
 
+extern const std::array<PeepholeRule, 4> PEEPHOLE_RULES;
+
 class Peephole {
   public:
     Peephole(std::vector<Instruction>& instructions, OptimizationFlags flags);
     void run();
-    void run_helper(Window& window);
+    void thread_jumps();
+    void rewrite_blocks();
+    void apply_rules(std::vector<size_t>& kept);
+    auto sink_into_join(size_t leader, Instruction& pop) -> bool;
+    auto collect_producers(size_t leader, std::vector<size_t>& producers)
+        -> bool;
+    auto add_producer(int tail, size_t leader, std::vector<size_t>& producers)
+        -> bool;
+    auto remove_fallthrough_jumps() -> bool;
     void apply_removal();
 
+    struct BlockEntry {
+        bool falls_through;
+        int tail;
+        size_t previous;
+    };
+
     std::vector<Instruction>& instructions;
-    bool optimize_offload {true};
-    bool optimize_const_sink {true};
+    OptimizationFlags flags;
+    std::vector<std::vector<size_t>> incoming;
+    std::vector<BlockEntry> entries;
+    std::vector<int> jump_tails;
+    std::vector<size_t> jump_blocks;
+    std::map<std::string_view, int> hits;
 };
 
-auto follow_jumps(std::vector<Instruction>& instructions, Instruction* start)
-    -> Instruction*;
-
 } // namespace dgeval::ast
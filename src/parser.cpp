@@ -0,0 +1,1418 @@
+// A Bison parser, made by GNU Bison 3.8.2.
+
+// Skeleton implementation for Bison LALR(1) parsers in C++
+
+// Copyright (C) 2002-2015, 2018-2021 Free Software Foundation, Inc.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// As a special exception, you may create a larger work that contains
+// part or all of the Bison parser skeleton and distribute that work
+// under terms of your choice, so long as that work isn't itself a
+// parser generator using the skeleton or a modified version thereof
+// as a parser skeleton.  Alternatively, if you modify or redistribute
+// the parser skeleton itself, you may (at your option) remove this
+// special exception, which will cause the skeleton and the resulting
+// Bison output files to be licensed under the GNU General Public
+// License without this special exception.
+
+// This special exception was added by the Free Software Foundation in
+// version 2.2 of Bison.
+
+// DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+// especially those whose name start with YY_ or yy_.  They are
+// private implementation details that can be changed or removed.
+
+
+
+
+
+#include "parser.hpp"
+
+
+// Unqualified %code blocks.
+#line 26 "src/parser.yy"
+
+    #include "scanner.hpp"
+    #define yylex lexer.yylex
+
+#line 51 "src/parser.cpp"
+
+
+#ifndef YY_
+# if defined YYENABLE_NLS && YYENABLE_NLS
+#  if ENABLE_NLS
+#   include <libintl.h> // FIXME: INFRINGES ON USER NAME SPACE.
+#   define YY_(msgid) dgettext ("bison-runtime", msgid)
+#  endif
+# endif
+# ifndef YY_
+#  define YY_(msgid) msgid
+# endif
+#endif
+
+
+// Whether we are compiled with exception support.
+#ifndef YY_EXCEPTIONS
+# if defined __GNUC__ && !defined __EXCEPTIONS
+#  define YY_EXCEPTIONS 0
+# else
+#  define YY_EXCEPTIONS 1
+# endif
+#endif
+
+#define YYRHSLOC(Rhs, K) ((Rhs)[K].location)
+/* YYLLOC_DEFAULT -- Set CURRENT to span from RHS[1] to RHS[N].
+   If N is 0, then set CURRENT to the empty location which ends
+   the previous symbol: RHS[0] (always defined).  */
+
+# ifndef YYLLOC_DEFAULT
+#  define YYLLOC_DEFAULT(Current, Rhs, N)                               \
+    do                                                                  \
+      if (N)                                                            \
+        {                                                               \
+          (Current).begin  = YYRHSLOC (Rhs, 1).begin;                   \
+          (Current).end    = YYRHSLOC (Rhs, N).end;                     \
+        }                                                               \
+      else                                                              \
+        {                                                               \
+          (Current).begin = (Current).end = YYRHSLOC (Rhs, 0).end;      \
+        }                                                               \
+    while (false)
+# endif
+
+
+// Enable debugging if requested.
+#if YYDEBUG
+
+// A pseudo ostream that takes yydebug_ into account.
+# define YYCDEBUG if (yydebug_) (*yycdebug_)
+
+# define YY_SYMBOL_PRINT(Title, Symbol)         \
+  do {                                          \
+    if (yydebug_)                               \
+    {                                           \
+      *yycdebug_ << Title << ' ';               \
+      yy_print_ (*yycdebug_, Symbol);           \
+      *yycdebug_ << '\n';                       \
+    }                                           \
+  } while (false)
+
+# define YY_REDUCE_PRINT(Rule)          \
+  do {                                  \
+    if (yydebug_)                       \
+      yy_reduce_print_ (Rule);          \
+  } while (false)
+
+# define YY_STACK_PRINT()               \
+  do {                                  \
+    if (yydebug_)                       \
+      yy_stack_print_ ();                \
+  } while (false)
+
+#else // !YYDEBUG
+
+# define YYCDEBUG if (false) std::cerr
+# define YY_SYMBOL_PRINT(Title, Symbol)  YY_USE (Symbol)
+# define YY_REDUCE_PRINT(Rule)           static_cast<void> (0)
+# define YY_STACK_PRINT()                static_cast<void> (0)
+
+#endif // !YYDEBUG
+
+#define yyerrok         (yyerrstatus_ = 0)
+#define yyclearin       (yyla.clear ())
+
+#define YYACCEPT        goto yyacceptlab
+#define YYABORT         goto yyabortlab
+#define YYERROR         goto yyerrorlab
+#define YYRECOVERING()  (!!yyerrstatus_)
+
+#line 5 "src/parser.yy"
+namespace  dgeval  {
+#line 144 "src/parser.cpp"
+
+  /// Build a parser object.
+   Parser :: Parser  (Driver& driver_yyarg, Lexer& lexer_yyarg)
+#if YYDEBUG
+    : yydebug_ (false),
+      yycdebug_ (&std::cerr),
+#else
+    :
+#endif
+      driver (driver_yyarg),
+      lexer (lexer_yyarg)
+  {}
+
+   Parser ::~ Parser  ()
+  {}
+
+   Parser ::syntax_error::~syntax_error () YY_NOEXCEPT YY_NOTHROW
+  {}
+
+  /*---------.
+  | symbol.  |
+  `---------*/
+
+
+
+  // by_state.
+   Parser ::by_state::by_state () YY_NOEXCEPT
+    : state (empty_state)
+  {}
+
+   Parser ::by_state::by_state (const by_state& that) YY_NOEXCEPT
+    : state (that.state)
+  {}
+
+  void
+   Parser ::by_state::clear () YY_NOEXCEPT
+  {
+    state = empty_state;
+  }
+
+  void
+   Parser ::by_state::move (by_state& that)
+  {
+    state = that.state;
+    that.clear ();
+  }
+
+   Parser ::by_state::by_state (state_type s) YY_NOEXCEPT
+    : state (s)
+  {}
+
+   Parser ::symbol_kind_type
+   Parser ::by_state::kind () const YY_NOEXCEPT
+  {
+    if (state == empty_state)
+      return symbol_kind::S_YYEMPTY;
+    else
+      return YY_CAST (symbol_kind_type, yystos_[+state]);
+  }
+
+   Parser ::stack_symbol_type::stack_symbol_type ()
+  {}
+
+   Parser ::stack_symbol_type::stack_symbol_type (YY_RVREF (stack_symbol_type) that)
+    : super_type (YY_MOVE (that.state), YY_MOVE (that.location))
+  {
+    switch (that.kind ())
+    {
+      case symbol_kind::S_NUMBER: // NUMBER
+        value.YY_MOVE_OR_COPY< double > (YY_MOVE (that.value));
+        break;
+
+      case symbol_kind::S_IDENTIFIER: // IDENTIFIER
+      case symbol_kind::S_STRING: // STRING
+        value.YY_MOVE_OR_COPY< std::string > (YY_MOVE (that.value));
+        break;
+
+      case symbol_kind::S_expression: // expression
+      case symbol_kind::S_literal: // literal
+      case symbol_kind::S_arithmetic_expression: // arithmetic_expression
+      case symbol_kind::S_logical_expression: // logical_expression
+      case symbol_kind::S_comparison_expression: // comparison_expression
+      case symbol_kind::S_negation_expression: // negation_expression
+      case symbol_kind::S_assignment: // assignment
+      case symbol_kind::S_conditional: // conditional
+      case symbol_kind::S_array_access: // array_access
+      case symbol_kind::S_function_call: // function_call
+      case symbol_kind::S_argument_list: // argument_list
+        value.YY_MOVE_OR_COPY< std::unique_ptr<ast::Expression> > (YY_MOVE (that.value));
+        break;
+
+      case symbol_kind::S_statement: // statement
+      case symbol_kind::S_expression_statement: // expression_statement
+      case symbol_kind::S_wait_statement: // wait_statement
+        value.YY_MOVE_OR_COPY< std::unique_ptr<ast::Statement> > (YY_MOVE (that.value));
+        break;
+
+      case symbol_kind::S_statement_list: // statement_list
+        value.YY_MOVE_OR_COPY< std::unique_ptr<ast::StatementList> > (YY_MOVE (that.value));
+        break;
+
+      case symbol_kind::S_identifier_list: // identifier_list
+        value.YY_MOVE_OR_COPY< std::vector<std::string> > (YY_MOVE (that.value));
+        break;
+
+      default:
+        break;
+    }
+
+#if 201103L <= YY_CPLUSPLUS
+    // that is emptied.
+    that.state = empty_state;
+#endif
+  }
+
+   Parser ::stack_symbol_type::stack_symbol_type (state_type s, YY_MOVE_REF (symbol_type) that)
+    : super_type (s, YY_MOVE (that.location))
+  {
+    switch (that.kind ())
+    {
+      case symbol_kind::S_NUMBER: // NUMBER
+        value.move< double > (YY_MOVE (that.value));
+        break;
+
+      case symbol_kind::S_IDENTIFIER: // IDENTIFIER
+      case symbol_kind::S_STRING: // STRING
+        value.move< std::string > (YY_MOVE (that.value));
+        break;
+
+      case symbol_kind::S_expression: // expression
+      case symbol_kind::S_literal: // literal
+      case symbol_kind::S_arithmetic_expression: // arithmetic_expression
+      case symbol_kind::S_logical_expression: // logical_expression
+      case symbol_kind::S_comparison_expression: // comparison_expression
+      case symbol_kind::S_negation_expression: // negation_expression
+      case symbol_kind::S_assignment: // assignment
+      case symbol_kind::S_conditional: // conditional
+      case symbol_kind::S_array_access: // array_access
+      case symbol_kind::S_function_call: // function_call
+      case symbol_kind::S_argument_list: // argument_list
+        value.move< std::unique_ptr<ast::Expression> > (YY_MOVE (that.value));
+        break;
+
+      case symbol_kind::S_statement: // statement
+      case symbol_kind::S_expression_statement: // expression_statement
+      case symbol_kind::S_wait_statement: // wait_statement
+        value.move< std::unique_ptr<ast::Statement> > (YY_MOVE (that.value));
+        break;
+
+      case symbol_kind::S_statement_list: // statement_list
+        value.move< std::unique_ptr<ast::StatementList> > (YY_MOVE (that.value));
+        break;
+
+      case symbol_kind::S_identifier_list: // identifier_list
+        value.move< std::vector<std::string> > (YY_MOVE (that.value));
+        break;
+
+      default:
+        break;
+    }
+
+    // that is emptied.
+    that.kind_ = symbol_kind::S_YYEMPTY;
+  }
+
+#if YY_CPLUSPLUS < 201103L
+   Parser ::stack_symbol_type&
+   Parser ::stack_symbol_type::operator= (const stack_symbol_type& that)
+  {
+    state = that.state;
+    switch (that.kind ())
+    {
+      case symbol_kind::S_NUMBER: // NUMBER
+        value.copy< double > (that.value);
+        break;
+
+      case symbol_kind::S_IDENTIFIER: // IDENTIFIER
+      case symbol_kind::S_STRING: // STRING
+        value.copy< std::string > (that.value);
+        break;
+
+      case symbol_kind::S_expression: // expression
+      case symbol_kind::S_literal: // literal
+      case symbol_kind::S_arithmetic_expression: // arithmetic_expression
+      case symbol_kind::S_logical_expression: // logical_expression
+      case symbol_kind::S_comparison_expression: // comparison_expression
+      case symbol_kind::S_negation_expression: // negation_expression
+      case symbol_kind::S_assignment: // assignment
+      case symbol_kind::S_conditional: // conditional
+      case symbol_kind::S_array_access: // array_access
+      case symbol_kind::S_function_call: // function_call
+      case symbol_kind::S_argument_list: // argument_list
+        value.copy< std::unique_ptr<ast::Expression> > (that.value);
+        break;
+
+      case symbol_kind::S_statement: // statement
+      case symbol_kind::S_expression_statement: // expression_statement
+      case symbol_kind::S_wait_statement: // wait_statement
+        value.copy< std::unique_ptr<ast::Statement> > (that.value);
+        break;
+
+      case symbol_kind::S_statement_list: // statement_list
+        value.copy< std::unique_ptr<ast::StatementList> > (that.value);
+        break;
+
+      case symbol_kind::S_identifier_list: // identifier_list
+        value.copy< std::vector<std::string> > (that.value);
+        break;
+
+      default:
+        break;
+    }
+
+    location = that.location;
+    return *this;
+  }
+
+   Parser ::stack_symbol_type&
+   Parser ::stack_symbol_type::operator= (stack_symbol_type& that)
+  {
+    state = that.state;
+    switch (that.kind ())
+    {
+      case symbol_kind::S_NUMBER: // NUMBER
+        value.move< double > (that.value);
+        break;
+
+      case symbol_kind::S_IDENTIFIER: // IDENTIFIER
+      case symbol_kind::S_STRING: // STRING
+        value.move< std::string > (that.value);
+        break;
+
+      case symbol_kind::S_expression: // expression
+      case symbol_kind::S_literal: // literal
+      case symbol_kind::S_arithmetic_expression: // arithmetic_expression
+      case symbol_kind::S_logical_expression: // logical_expression
+      case symbol_kind::S_comparison_expression: // comparison_expression
+      case symbol_kind::S_negation_expression: // negation_expression
+      case symbol_kind::S_assignment: // assignment
+      case symbol_kind::S_conditional: // conditional
+      case symbol_kind::S_array_access: // array_access
+      case symbol_kind::S_function_call: // function_call
+      case symbol_kind::S_argument_list: // argument_list
+        value.move< std::unique_ptr<ast::Expression> > (that.value);
+        break;
+
+      case symbol_kind::S_statement: // statement
+      case symbol_kind::S_expression_statement: // expression_statement
+      case symbol_kind::S_wait_statement: // wait_statement
+        value.move< std::unique_ptr<ast::Statement> > (that.value);
+        break;
+
+      case symbol_kind::S_statement_list: // statement_list
+        value.move< std::unique_ptr<ast::StatementList> > (that.value);
+        break;
+
+      case symbol_kind::S_identifier_list: // identifier_list
+        value.move< std::vector<std::string> > (that.value);
+        break;
+
+      default:
+        break;
+    }
+
+    location = that.location;
+    // that is emptied.
+    that.state = empty_state;
+    return *this;
+  }
+#endif
+
+  template <typename Base>
+  void
+   Parser ::yy_destroy_ (const char* yymsg, basic_symbol<Base>& yysym) const
+  {
+    if (yymsg)
+      YY_SYMBOL_PRINT (yymsg, yysym);
+  }
+
+#if YYDEBUG
+  template <typename Base>
+  void
+   Parser ::yy_print_ (std::ostream& yyo, const basic_symbol<Base>& yysym) const
+  {
+    std::ostream& yyoutput = yyo;
+    YY_USE (yyoutput);
+    if (yysym.empty ())
+      yyo << "empty symbol";
+    else
+      {
+        symbol_kind_type yykind = yysym.kind ();
+        yyo << (yykind < YYNTOKENS ? "token" : "nterm")
+            << ' ' << yysym.name () << " ("
+            << yysym.location << ": ";
+        YY_USE (yykind);
+        yyo << ')';
+      }
+  }
+#endif
+
+  void
+   Parser ::yypush_ (const char* m, YY_MOVE_REF (stack_symbol_type) sym)
+  {
+    if (m)
+      YY_SYMBOL_PRINT (m, sym);
+    yystack_.push (YY_MOVE (sym));
+  }
+
+  void
+   Parser ::yypush_ (const char* m, state_type s, YY_MOVE_REF (symbol_type) sym)
+  {
+#if 201103L <= YY_CPLUSPLUS
+    yypush_ (m, stack_symbol_type (s, std::move (sym)));
+#else
+    stack_symbol_type ss (s, sym);
+    yypush_ (m, ss);
+#endif
+  }
+
+  void
+   Parser ::yypop_ (int n) YY_NOEXCEPT
+  {
+    yystack_.pop (n);
+  }
+
+#if YYDEBUG
+  std::ostream&
+   Parser ::debug_stream () const
+  {
+    return *yycdebug_;
+  }
+
+  void
+   Parser ::set_debug_stream (std::ostream& o)
+  {
+    yycdebug_ = &o;
+  }
+
+
+   Parser ::debug_level_type
+   Parser ::debug_level () const
+  {
+    return yydebug_;
+  }
+
+  void
+   Parser ::set_debug_level (debug_level_type l)
+  {
+    yydebug_ = l;
+  }
+#endif // YYDEBUG
+
+   Parser ::state_type
+   Parser ::yy_lr_goto_state_ (state_type yystate, int yysym)
+  {
+    int yyr = yypgoto_[yysym - YYNTOKENS] + yystate;
+    if (0 <= yyr && yyr <= yylast_ && yycheck_[yyr] == yystate)
+      return yytable_[yyr];
+    else
+      return yydefgoto_[yysym - YYNTOKENS];
+  }
+
+  bool
+   Parser ::yy_pact_value_is_default_ (int yyvalue) YY_NOEXCEPT
+  {
+    return yyvalue == yypact_ninf_;
+  }
+
+  bool
+   Parser ::yy_table_value_is_error_ (int yyvalue) YY_NOEXCEPT
+  {
+    return yyvalue == yytable_ninf_;
+  }
+
+  int
+   Parser ::operator() ()
+  {
+    return parse ();
+  }
+
+  int
+   Parser ::parse ()
+  {
+    int yyn;
+    /// Length of the RHS of the rule being reduced.
+    int yylen = 0;
+
+    // Error handling.
+    int yynerrs_ = 0;
+    int yyerrstatus_ = 0;
+
+    /// The lookahead symbol.
+    symbol_type yyla;
+
+    /// The locations where the error started and ended.
+    stack_symbol_type yyerror_range[3];
+
+    /// The return value of parse ().
+    int yyresult;
+
+#if YY_EXCEPTIONS
+    try
+#endif // YY_EXCEPTIONS
+      {
+    YYCDEBUG << "Starting parse\n";
+
+
+    /* Initialize the stack.  The initial state will be set in
+       yynewstate, since the latter expects the semantical and the
+       location values to have been already stored, initialize these
+       stacks with a primary value.  */
+    yystack_.clear ();
+    yypush_ (YY_NULLPTR, 0, YY_MOVE (yyla));
+
+  /*-----------------------------------------------.
+  | yynewstate -- push a new symbol on the stack.  |
+  `-----------------------------------------------*/
+  yynewstate:
+    YYCDEBUG << "Entering state " << int (yystack_[0].state) << '\n';
+    YY_STACK_PRINT ();
+
+    // Accept?
+    if (yystack_[0].state == yyfinal_)
+      YYACCEPT;
+
+    goto yybackup;
+
+
+  /*-----------.
+  | yybackup.  |
+  `-----------*/
+  yybackup:
+    // Try to take a decision without lookahead.
+    yyn = yypact_[+yystack_[0].state];
+    if (yy_pact_value_is_default_ (yyn))
+      goto yydefault;
+
+    // Read a lookahead token.
+    if (yyla.empty ())
+      {
+        YYCDEBUG << "Reading a token\n";
+#if YY_EXCEPTIONS
+        try
+#endif // YY_EXCEPTIONS
+          {
+            symbol_type yylookahead (yylex (driver));
+            yyla.move (yylookahead);
+          }
+#if YY_EXCEPTIONS
+        catch (const syntax_error& yyexc)
+          {
+            YYCDEBUG << "Caught exception: " << yyexc.what() << '\n';
+            error (yyexc);
+            goto yyerrlab1;
+          }
+#endif // YY_EXCEPTIONS
+      }
+    YY_SYMBOL_PRINT ("Next token is", yyla);
+
+    if (yyla.kind () == symbol_kind::S_YYerror)
+    {
+      // The scanner already issued an error message, process directly
+      // to error recovery.  But do not keep the error token as
+      // lookahead, it is too special and may lead us to an endless
+      // loop in error recovery. */
+      yyla.kind_ = symbol_kind::S_YYUNDEF;
+      goto yyerrlab1;
+    }
+
+    /* If the proper action on seeing token YYLA.TYPE is to reduce or
+       to detect an error, take that action.  */
+    yyn += yyla.kind ();
+    if (yyn < 0 || yylast_ < yyn || yycheck_[yyn] != yyla.kind ())
+      {
+        goto yydefault;
+      }
+
+    // Reduce or error.
+    yyn = yytable_[yyn];
+    if (yyn <= 0)
+      {
+        if (yy_table_value_is_error_ (yyn))
+          goto yyerrlab;
+        yyn = -yyn;
+        goto yyreduce;
+      }
+
+    // Count tokens shifted since error; after three, turn off error status.
+    if (yyerrstatus_)
+      --yyerrstatus_;
+
+    // Shift the lookahead token.
+    yypush_ ("Shifting", state_type (yyn), YY_MOVE (yyla));
+    goto yynewstate;
+
+
+  /*-----------------------------------------------------------.
+  | yydefault -- do the default action for the current state.  |
+  `-----------------------------------------------------------*/
+  yydefault:
+    yyn = yydefact_[+yystack_[0].state];
+    if (yyn == 0)
+      goto yyerrlab;
+    goto yyreduce;
+
+
+  /*-----------------------------.
+  | yyreduce -- do a reduction.  |
+  `-----------------------------*/
+  yyreduce:
+    yylen = yyr2_[yyn];
+    {
+      stack_symbol_type yylhs;
+      yylhs.state = yy_lr_goto_state_ (yystack_[yylen].state, yyr1_[yyn]);
+      /* Variants are always initialized to an empty instance of the
+         correct type. The default '$$ = $1' action is NOT applied
+         when using variants.  */
+      switch (yyr1_[yyn])
+    {
+      case symbol_kind::S_NUMBER: // NUMBER
+        yylhs.value.emplace< double > ();
+        break;
+
+      case symbol_kind::S_IDENTIFIER: // IDENTIFIER
+      case symbol_kind::S_STRING: // STRING
+        yylhs.value.emplace< std::string > ();
+        break;
+
+      case symbol_kind::S_expression: // expression
+      case symbol_kind::S_literal: // literal
+      case symbol_kind::S_arithmetic_expression: // arithmetic_expression
+      case symbol_kind::S_logical_expression: // logical_expression
+      case symbol_kind::S_comparison_expression: // comparison_expression
+      case symbol_kind::S_negation_expression: // negation_expression
+      case symbol_kind::S_assignment: // assignment
+      case symbol_kind::S_conditional: // conditional
+      case symbol_kind::S_array_access: // array_access
+      case symbol_kind::S_function_call: // function_call
+      case symbol_kind::S_argument_list: // argument_list
+        yylhs.value.emplace< std::unique_ptr<ast::Expression> > ();
+        break;
+
+      case symbol_kind::S_statement: // statement
+      case symbol_kind::S_expression_statement: // expression_statement
+      case symbol_kind::S_wait_statement: // wait_statement
+        yylhs.value.emplace< std::unique_ptr<ast::Statement> > ();
+        break;
+
+      case symbol_kind::S_statement_list: // statement_list
+        yylhs.value.emplace< std::unique_ptr<ast::StatementList> > ();
+        break;
+
+      case symbol_kind::S_identifier_list: // identifier_list
+        yylhs.value.emplace< std::vector<std::string> > ();
+        break;
+
+      default:
+        break;
+    }
+
+
+      // Default location.
+      {
+        stack_type::slice range (yystack_, yylen);
+        YYLLOC_DEFAULT (yylhs.location, range, yylen);
+        yyerror_range[1].location = yylhs.location;
+      }
+
+      // Perform the reduction.
+      YY_REDUCE_PRINT (yyn);
+#if YY_EXCEPTIONS
+      try
+#endif // YY_EXCEPTIONS
+        {
+          switch (yyn)
+            {
+  case 2: // program: statement_list
+#line 81 "src/parser.yy"
+                                            { driver.program = std::make_unique<ast::Program>(YY_MOVE (yystack_[0].value.as < std::unique_ptr<ast::StatementList> > ())); }
+#line 724 "src/parser.cpp"
+    break;
+
+  case 3: // statement_list: statement
+#line 83 "src/parser.yy"
+                                            { yylhs.value.as < std::unique_ptr<ast::StatementList> > () = std::make_unique<ast::StatementList>(); yylhs.value.as < std::unique_ptr<ast::StatementList> > ()->inner.push_back(YY_MOVE (yystack_[0].value.as < std::unique_ptr<ast::Statement> > ())); }
+#line 730 "src/parser.cpp"
+    break;
+
+  case 4: // statement_list: statement_list statement
+#line 84 "src/parser.yy"
+                                            { yylhs.value.as < std::unique_ptr<ast::StatementList> > () = YY_MOVE (yystack_[1].value.as < std::unique_ptr<ast::StatementList> > ()); yylhs.value.as < std::unique_ptr<ast::StatementList> > ()->inner.push_back(YY_MOVE (yystack_[0].value.as < std::unique_ptr<ast::Statement> > ())); }
+#line 736 "src/parser.cpp"
+    break;
+
+  case 5: // statement: expression_statement
+#line 87 "src/parser.yy"
+            { yylhs.value.as < std::unique_ptr<ast::Statement> > () = YY_MOVE (yystack_[0].value.as < std::unique_ptr<ast::Statement> > ()); }
+#line 742 "src/parser.cpp"
+    break;
+
+  case 6: // statement: wait_statement
+#line 88 "src/parser.yy"
+            { yylhs.value.as < std::unique_ptr<ast::Statement> > () = YY_MOVE (yystack_[0].value.as < std::unique_ptr<ast::Statement> > ()); }
+#line 748 "src/parser.cpp"
+    break;
+
+  case 7: // expression_statement: expression ";"
+#line 91 "src/parser.yy"
+                                                                { yylhs.value.as < std::unique_ptr<ast::Statement> > () = std::make_unique<ast::ExpressionStatement>(yystack_[1].location, YY_MOVE (yystack_[1].value.as < std::unique_ptr<ast::Expression> > ())); }
+#line 754 "src/parser.cpp"
+    break;
+
+  case 8: // wait_statement: "wait" identifier_list "then" expression ";"
+#line 93 "src/parser.yy"
+                                                                { yylhs.value.as < std::unique_ptr<ast::Statement> > () = std::make_unique<ast::WaitStatement>(yystack_[4].location, YY_MOVE (yystack_[3].value.as < std::vector<std::string> > ()), YY_MOVE (yystack_[1].value.as < std::unique_ptr<ast::Expression> > ())); }
+#line 760 "src/parser.cpp"
+    break;
+
+  case 9: // identifier_list: IDENTIFIER
+#line 95 "src/parser.yy"
+                                                                { yylhs.value.as < std::vector<std::string> > () = std::vector<std::string>(); yylhs.value.as < std::vector<std::string> > ().push_back(YY_MOVE (yystack_[0].value.as < std::string > ())); }
+#line 766 "src/parser.cpp"
+    break;
+
+  case 10: // identifier_list: identifier_list "," IDENTIFIER
+#line 96 "src/parser.yy"
+                                                                { yylhs.value.as < std::vector<std::string> > () = YY_MOVE (yystack_[2].value.as < std::vector<std::string> > ()); yylhs.value.as < std::vector<std::string> > ().push_back(YY_MOVE (yystack_[0].value.as < std::string > ())); }
+#line 772 "src/parser.cpp"
+    break;
+
+  case 11: // expression: literal
+#line 99 "src/parser.yy"
+             { yylhs.value.as < std::unique_ptr<ast::Expression> > () = YY_MOVE (yystack_[0].value.as < std::unique_ptr<ast::Expression> > ()); }
+#line 778 "src/parser.cpp"
+    break;
+
+  case 12: // expression: assignment
+#line 100 "src/parser.yy"
+             { yylhs.value.as < std::unique_ptr<ast::Expression> > () = YY_MOVE (yystack_[0].value.as < std::unique_ptr<ast::Expression> > ()); }
+#line 784 "src/parser.cpp"
+    break;
+
+  case 13: // expression: function_call
+#line 101 "src/parser.yy"
+             { yylhs.value.as < std::unique_ptr<ast::Expression> > () = YY_MOVE (yystack_[0].value.as < std::unique_ptr<ast::Expression> > ()); }
+#line 790 "src/parser.cpp"
+    break;
+
+  case 14: // expression: array_access
+#line 102 "src/parser.yy"
+             { yylhs.value.as < std::unique_ptr<ast::Expression> > () = YY_MOVE (yystack_[0].value.as < std::unique_ptr<ast::Expression> > ()); }
+#line 796 "src/parser.cpp"
+    break;
+
+  case 15: // expression: conditional
+#line 103 "src/parser.yy"
+             { yylhs.value.as < std::unique_ptr<ast::Expression> > () = YY_MOVE (yystack_[0].value.as < std::unique_ptr<ast::Expression> > ()); }
+#line 802 "src/parser.cpp"
+    break;
+
+  case 16: // expression: arithmetic_expression
+#line 104 "src/parser.yy"
+             { yylhs.value.as < std::unique_ptr<ast::Expression> > () = YY_MOVE (yystack_[0].value.as < std::unique_ptr<ast::Expression> > ()); }
+#line 808 "src/parser.cpp"
+    break;
+
+  case 17: // expression: logical_expression
+#line 105 "src/parser.yy"
+             { yylhs.value.as < std::unique_ptr<ast::Expression> > () = YY_MOVE (yystack_[0].value.as < std::unique_ptr<ast::Expression> > ()); }
+#line 814 "src/parser.cpp"
+    break;
+
+  case 18: // expression: comparison_expression
+#line 106 "src/parser.yy"
+             { yylhs.value.as < std::unique_ptr<ast::Expression> > () = YY_MOVE (yystack_[0].value.as < std::unique_ptr<ast::Expression> > ()); }
+#line 820 "src/parser.cpp"
+    break;
+
+  case 19: // expression: negation_expression
+#line 107 "src/parser.yy"
+             { yylhs.value.as < std::unique_ptr<ast::Expression> > () = YY_MOVE (yystack_[0].value.as < std::unique_ptr<ast::Expression> > ()); }
+#line 826 "src/parser.cpp"
+    break;
+
+  case 20: // expression: "(" expression ")"
+#line 108 "src/parser.yy"
+                                        { yylhs.value.as < std::unique_ptr<ast::Expression> > () = YY_MOVE (yystack_[1].value.as < std::unique_ptr<ast::Expression> > ()); }
+#line 832 "src/parser.cpp"
+    break;
+
+  case 21: // expression: expression "," expression
+#line 109 "src/parser.yy"
+                                        { yylhs.value.as < std::unique_ptr<ast::Expression> > () = std::make_unique<ast::BinaryExpression>(yystack_[1].location, YY_MOVE (yystack_[2].value.as < std::unique_ptr<ast::Expression> > ()), YY_MOVE (yystack_[0].value.as < std::unique_ptr<ast::Expression> > ()), ast::Opcode::Comma); }
+#line 838 "src/parser.cpp"
+    break;
+
+  case 22: // literal: STRING
+#line 112 "src/parser.yy"
+                                        { yylhs.value.as < std::unique_ptr<ast::Expression> > () = std::make_unique<ast::StringLiteral>(yystack_[0].location, YY_MOVE (yystack_[0].value.as < std::string > ())); }
+#line 844 "src/parser.cpp"
+    break;
+
+  case 23: // literal: NUMBER
+#line 113 "src/parser.yy"
+                                        { yylhs.value.as < std::unique_ptr<ast::Expression> > () = std::make_unique<ast::NumberLiteral>(yystack_[0].location, YY_MOVE (yystack_[0].value.as < double > ())); }
+#line 850 "src/parser.cpp"
+    break;
+
+  case 24: // literal: IDENTIFIER
+#line 114 "src/parser.yy"
+                                        { yylhs.value.as < std::unique_ptr<ast::Expression> > () = std::make_unique<ast::Identifier>(yystack_[0].location, YY_MOVE (yystack_[0].value.as < std::string > ())); }
+#line 856 "src/parser.cpp"
+    break;
+
+  case 25: // literal: "true"
+#line 115 "src/parser.yy"
+                                        { yylhs.value.as < std::unique_ptr<ast::Expression> > () = std::make_unique<ast::BooleanLiteral>(yystack_[0].location, true); }
+#line 862 "src/parser.cpp"
+    break;
+
+  case 26: // literal: "false"
+#line 116 "src/parser.yy"
+                                        { yylhs.value.as < std::unique_ptr<ast::Expression> > () = std::make_unique<ast::BooleanLiteral>(yystack_[0].location, false); }
+#line 868 "src/parser.cpp"
+    break;
+
+  case 27: // literal: "[" expression "]"
+#line 117 "src/parser.yy"
+                                        { yylhs.value.as < std::unique_ptr<ast::Expression> > () = std::make_unique<ast::ArrayLiteral>(yystack_[2].location, YY_MOVE (yystack_[1].value.as < std::unique_ptr<ast::Expression> > ())); }
+#line 874 "src/parser.cpp"
+    break;
+
+  case 28: // arithmetic_expression: expression "+" expression
+#line 120 "src/parser.yy"
+                                                        { yylhs.value.as < std::unique_ptr<ast::Expression> > () = std::make_unique<ast::BinaryExpression>(yystack_[1].location, YY_MOVE (yystack_[2].value.as < std::unique_ptr<ast::Expression> > ()), YY_MOVE (yystack_[0].value.as < std::unique_ptr<ast::Expression> > ()), ast::Opcode::Add); }
+#line 880 "src/parser.cpp"
+    break;
+
+  case 29: // arithmetic_expression: expression "-" expression
+#line 121 "src/parser.yy"
+                                                        { yylhs.value.as < std::unique_ptr<ast::Expression> > () = std::make_unique<ast::BinaryExpression>(yystack_[1].location, YY_MOVE (yystack_[2].value.as < std::unique_ptr<ast::Expression> > ()), YY_MOVE (yystack_[0].value.as < std::unique_ptr<ast::Expression> > ()), ast::Opcode::Subtract); }
+#line 886 "src/parser.cpp"
+    break;
+
+  case 30: // arithmetic_expression: expression "*" expression
+#line 122 "src/parser.yy"
+                                                        { yylhs.value.as < std::unique_ptr<ast::Expression> > () = std::make_unique<ast::BinaryExpression>(yystack_[1].location, YY_MOVE (yystack_[2].value.as < std::unique_ptr<ast::Expression> > ()), YY_MOVE (yystack_[0].value.as < std::unique_ptr<ast::Expression> > ()), ast::Opcode::Multiply); }
+#line 892 "src/parser.cpp"
+    break;
+
+  case 31: // arithmetic_expression: expression "/" expression
+#line 123 "src/parser.yy"
+                                                        { yylhs.value.as < std::unique_ptr<ast::Expression> > () = std::make_unique<ast::BinaryExpression>(yystack_[1].location, YY_MOVE (yystack_[2].value.as < std::unique_ptr<ast::Expression> > ()), YY_MOVE (yystack_[0].value.as < std::unique_ptr<ast::Expression> > ()), ast::Opcode::Divide); }
+#line 898 "src/parser.cpp"
+    break;
+
+  case 32: // logical_expression: expression "&&" expression
+#line 126 "src/parser.yy"
+                                                        { yylhs.value.as < std::unique_ptr<ast::Expression> > () = std::make_unique<ast::BinaryExpression>(yystack_[1].location, YY_MOVE (yystack_[2].value.as < std::unique_ptr<ast::Expression> > ()), YY_MOVE (yystack_[0].value.as < std::unique_ptr<ast::Expression> > ()), ast::Opcode::And); }
+#line 904 "src/parser.cpp"
+    break;
+
+  case 33: // logical_expression: expression "||" expression
+#line 127 "src/parser.yy"
+                                                        { yylhs.value.as < std::unique_ptr<ast::Expression> > () = std::make_unique<ast::BinaryExpression>(yystack_[1].location, YY_MOVE (yystack_[2].value.as < std::unique_ptr<ast::Expression> > ()), YY_MOVE (yystack_[0].value.as < std::unique_ptr<ast::Expression> > ()), ast::Opcode::Or); }
+#line 910 "src/parser.cpp"
+    break;
+
+  case 34: // comparison_expression: expression "==" expression
+#line 130 "src/parser.yy"
+                                                        { yylhs.value.as < std::unique_ptr<ast::Expression> > () = std::make_unique<ast::BinaryExpression>(yystack_[1].location, YY_MOVE (yystack_[2].value.as < std::unique_ptr<ast::Expression> > ()), YY_MOVE (yystack_[0].value.as < std::unique_ptr<ast::Expression> > ()), ast::Opcode::Equal); }
+#line 916 "src/parser.cpp"
+    break;
+
+  case 35: // comparison_expression: expression "!=" expression
+#line 131 "src/parser.yy"
+                                                        { yylhs.value.as < std::unique_ptr<ast::Expression> > () = std::make_unique<ast::BinaryExpression>(yystack_[1].location, YY_MOVE (yystack_[2].value.as < std::unique_ptr<ast::Expression> > ()), YY_MOVE (yystack_[0].value.as < std::unique_ptr<ast::Expression> > ()), ast::Opcode::NotEqual); }
+#line 922 "src/parser.cpp"
+    break;
+
+  case 36: // comparison_expression: expression "<" expression
+#line 132 "src/parser.yy"
+                                                        { yylhs.value.as < std::unique_ptr<ast::Expression> > () = std::make_unique<ast::BinaryExpression>(yystack_[1].location, YY_MOVE (yystack_[2].value.as < std::unique_ptr<ast::Expression> > ()), YY_MOVE (yystack_[0].value.as < std::unique_ptr<ast::Expression> > ()), ast::Opcode::Less); }
+#line 928 "src/parser.cpp"
+    break;
+
+  case 37: // comparison_expression: expression ">" expression
+#line 133 "src/parser.yy"
+                                                        { yylhs.value.as < std::unique_ptr<ast::Expression> > () = std::make_unique<ast::BinaryExpression>(yystack_[1].location, YY_MOVE (yystack_[2].value.as < std::unique_ptr<ast::Expression> > ()), YY_MOVE (yystack_[0].value.as < std::unique_ptr<ast::Expression> > ()), ast::Opcode::Greater); }
+#line 934 "src/parser.cpp"
+    break;
+
+  case 38: // comparison_expression: expression "<=" expression
+#line 134 "src/parser.yy"
+                                                        { yylhs.value.as < std::unique_ptr<ast::Expression> > () = std::make_unique<ast::BinaryExpression>(yystack_[1].location, YY_MOVE (yystack_[2].value.as < std::unique_ptr<ast::Expression> > ()), YY_MOVE (yystack_[0].value.as < std::unique_ptr<ast::Expression> > ()), ast::Opcode::LessEqual); }
+#line 940 "src/parser.cpp"
+    break;
+
+  case 39: // comparison_expression: expression ">=" expression
+#line 135 "src/parser.yy"
+                                                        { yylhs.value.as < std::unique_ptr<ast::Expression> > () = std::make_unique<ast::BinaryExpression>(yystack_[1].location, YY_MOVE (yystack_[2].value.as < std::unique_ptr<ast::Expression> > ()), YY_MOVE (yystack_[0].value.as < std::unique_ptr<ast::Expression> > ()), ast::Opcode::GreaterEqual); }
+#line 946 "src/parser.cpp"
+    break;
+
+  case 40: // negation_expression: "!" expression
+#line 138 "src/parser.yy"
+                                                        { yylhs.value.as < std::unique_ptr<ast::Expression> > () = std::make_unique<ast::UnaryExpression>(yystack_[1].location, YY_MOVE (yystack_[0].value.as < std::unique_ptr<ast::Expression> > ()), ast::Opcode::Not); }
+#line 952 "src/parser.cpp"
+    break;
+
+  case 41: // negation_expression: "-" expression
+#line 139 "src/parser.yy"
+                                                        { yylhs.value.as < std::unique_ptr<ast::Expression> > () = std::make_unique<ast::UnaryExpression>(yystack_[1].location, YY_MOVE (yystack_[0].value.as < std::unique_ptr<ast::Expression> > ()), ast::Opcode::Minus); }
+#line 958 "src/parser.cpp"
+    break;
+
+  case 42: // assignment: expression "=" expression
+#line 142 "src/parser.yy"
+                                                        { yylhs.value.as < std::unique_ptr<ast::Expression> > () = std::make_unique<ast::BinaryExpression>(yystack_[1].location, YY_MOVE (yystack_[2].value.as < std::unique_ptr<ast::Expression> > ()), YY_MOVE (yystack_[0].value.as < std::unique_ptr<ast::Expression> > ()), ast::Opcode::Assign); }
+#line 964 "src/parser.cpp"
+    break;
+
+  case 43: // conditional: expression "?" expression ":" expression
+#line 144 "src/parser.yy"
+                                                        {
+                                                            yylhs.value.as < std::unique_ptr<ast::Expression> > () = std::make_unique<ast::BinaryExpression>(
+                                                                yystack_[3].location,
+                                                                YY_MOVE (yystack_[4].value.as < std::unique_ptr<ast::Expression> > ()),
+                                                                std::make_unique<ast::BinaryExpression>(yystack_[1].location, YY_MOVE (yystack_[2].value.as < std::unique_ptr<ast::Expression> > ()), YY_MOVE (yystack_[0].value.as < std::unique_ptr<ast::Expression> > ()), ast::Opcode::Alt),
+                                                                ast::Opcode::Conditional
+                                                            );
+                                                        }
+#line 977 "src/parser.cpp"
+    break;
+
+  case 44: // array_access: expression "[" expression "]"
+#line 153 "src/parser.yy"
+                                                        { yylhs.value.as < std::unique_ptr<ast::Expression> > () = std::make_unique<ast::BinaryExpression>(yystack_[2].location, YY_MOVE (yystack_[3].value.as < std::unique_ptr<ast::Expression> > ()), YY_MOVE (yystack_[1].value.as < std::unique_ptr<ast::Expression> > ()), ast::Opcode::ArrayAccess); }
+#line 983 "src/parser.cpp"
+    break;
+
+  case 45: // function_call: expression "(" argument_list ")"
+#line 155 "src/parser.yy"
+                                                        { yylhs.value.as < std::unique_ptr<ast::Expression> > () = std::make_unique<ast::BinaryExpression>(yystack_[2].location, YY_MOVE (yystack_[3].value.as < std::unique_ptr<ast::Expression> > ()), YY_MOVE (yystack_[1].value.as < std::unique_ptr<ast::Expression> > ()), ast::Opcode::Call); }
+#line 989 "src/parser.cpp"
+    break;
+
+  case 46: // argument_list: %empty
+#line 157 "src/parser.yy"
+                                { yylhs.value.as < std::unique_ptr<ast::Expression> > () = nullptr; }
+#line 995 "src/parser.cpp"
+    break;
+
+  case 47: // argument_list: expression
+#line 158 "src/parser.yy"
+                { yylhs.value.as < std::unique_ptr<ast::Expression> > () = YY_MOVE (yystack_[0].value.as < std::unique_ptr<ast::Expression> > ()); }
+#line 1001 "src/parser.cpp"
+    break;
+
+
+#line 1005 "src/parser.cpp"
+
+            default:
+              break;
+            }
+        }
+#if YY_EXCEPTIONS
+      catch (const syntax_error& yyexc)
+        {
+          YYCDEBUG << "Caught exception: " << yyexc.what() << '\n';
+          error (yyexc);
+          YYERROR;
+        }
+#endif // YY_EXCEPTIONS
+      YY_SYMBOL_PRINT ("-> $$ =", yylhs);
+      yypop_ (yylen);
+      yylen = 0;
+
+      // Shift the result of the reduction.
+      yypush_ (YY_NULLPTR, YY_MOVE (yylhs));
+    }
+    goto yynewstate;
+
+
+  /*--------------------------------------.
+  | yyerrlab -- here on detecting error.  |
+  `--------------------------------------*/
+  yyerrlab:
+    // If not already recovering from an error, report this error.
+    if (!yyerrstatus_)
+      {
+        ++yynerrs_;
+        std::string msg = YY_("syntax error");
+        error (yyla.location, YY_MOVE (msg));
+      }
+
+
+    yyerror_range[1].location = yyla.location;
+    if (yyerrstatus_ == 3)
+      {
+        /* If just tried and failed to reuse lookahead token after an
+           error, discard it.  */
+
+        // Return failure if at end of input.
+        if (yyla.kind () == symbol_kind::S_YYEOF)
+          YYABORT;
+        else if (!yyla.empty ())
+          {
+            yy_destroy_ ("Error: discarding", yyla);
+            yyla.clear ();
+          }
+      }
+
+    // Else will try to reuse lookahead token after shifting the error token.
+    goto yyerrlab1;
+
+
+  /*---------------------------------------------------.
+  | yyerrorlab -- error raised explicitly by YYERROR.  |
+  `---------------------------------------------------*/
+  yyerrorlab:
+    /* Pacify compilers when the user code never invokes YYERROR and
+       the label yyerrorlab therefore never appears in user code.  */
+    if (false)
+      YYERROR;
+
+    /* Do not reclaim the symbols of the rule whose action triggered
+       this YYERROR.  */
+    yypop_ (yylen);
+    yylen = 0;
+    YY_STACK_PRINT ();
+    goto yyerrlab1;
+
+
+  /*-------------------------------------------------------------.
+  | yyerrlab1 -- common code for both syntax error and YYERROR.  |
+  `-------------------------------------------------------------*/
+  yyerrlab1:
+    yyerrstatus_ = 3;   // Each real token shifted decrements this.
+    // Pop stack until we find a state that shifts the error token.
+    for (;;)
+      {
+        yyn = yypact_[+yystack_[0].state];
+        if (!yy_pact_value_is_default_ (yyn))
+          {
+            yyn += symbol_kind::S_YYerror;
+            if (0 <= yyn && yyn <= yylast_
+                && yycheck_[yyn] == symbol_kind::S_YYerror)
+              {
+                yyn = yytable_[yyn];
+                if (0 < yyn)
+                  break;
+              }
+          }
+
+        // Pop the current state because it cannot handle the error token.
+        if (yystack_.size () == 1)
+          YYABORT;
+
+        yyerror_range[1].location = yystack_[0].location;
+        yy_destroy_ ("Error: popping", yystack_[0]);
+        yypop_ ();
+        YY_STACK_PRINT ();
+      }
+    {
+      stack_symbol_type error_token;
+
+      yyerror_range[2].location = yyla.location;
+      YYLLOC_DEFAULT (error_token.location, yyerror_range, 2);
+
+      // Shift the error token.
+      error_token.state = state_type (yyn);
+      yypush_ ("Shifting", YY_MOVE (error_token));
+    }
+    goto yynewstate;
+
+
+  /*-------------------------------------.
+  | yyacceptlab -- YYACCEPT comes here.  |
+  `-------------------------------------*/
+  yyacceptlab:
+    yyresult = 0;
+    goto yyreturn;
+
+
+  /*-----------------------------------.
+  | yyabortlab -- YYABORT comes here.  |
+  `-----------------------------------*/
+  yyabortlab:
+    yyresult = 1;
+    goto yyreturn;
+
+
+  /*-----------------------------------------------------.
+  | yyreturn -- parsing is finished, return the result.  |
+  `-----------------------------------------------------*/
+  yyreturn:
+    if (!yyla.empty ())
+      yy_destroy_ ("Cleanup: discarding lookahead", yyla);
+
+    /* Do not reclaim the symbols of the rule whose action triggered
+       this YYABORT or YYACCEPT.  */
+    yypop_ (yylen);
+    YY_STACK_PRINT ();
+    while (1 < yystack_.size ())
+      {
+        yy_destroy_ ("Cleanup: popping", yystack_[0]);
+        yypop_ ();
+      }
+
+    return yyresult;
+  }
+#if YY_EXCEPTIONS
+    catch (...)
+      {
+        YYCDEBUG << "Exception caught: cleaning lookahead and stack\n";
+        // Do not try to display the values of the reclaimed symbols,
+        // as their printers might throw an exception.
+        if (!yyla.empty ())
+          yy_destroy_ (YY_NULLPTR, yyla);
+
+        while (1 < yystack_.size ())
+          {
+            yy_destroy_ (YY_NULLPTR, yystack_[0]);
+            yypop_ ();
+          }
+        throw;
+      }
+#endif // YY_EXCEPTIONS
+  }
+
+  void
+   Parser ::error (const syntax_error& yyexc)
+  {
+    error (yyexc.location, yyexc.what ());
+  }
+
+#if YYDEBUG || 0
+  const char *
+   Parser ::symbol_name (symbol_kind_type yysymbol)
+  {
+    return yytname_[yysymbol];
+  }
+#endif // #if YYDEBUG || 0
+
+
+
+
+
+
+
+
+
+  const signed char  Parser ::yypact_ninf_ = -22;
+
+  const signed char  Parser ::yytable_ninf_ = -1;
+
+  const short
+   Parser ::yypact_[] =
+  {
+       1,    50,    50,    50,    50,   -22,   -22,   -21,   -22,   -22,
+     -22,     9,     1,   -22,   -22,   -22,    79,   -22,   -22,   -22,
+     -22,   -22,   -22,   -22,   -22,   -22,   100,   121,   275,     2,
+     -22,    10,   -22,   -22,    50,    50,    50,    50,    50,   -22,
+      50,    50,    50,    50,    50,    50,    50,    50,    50,    50,
+      50,    50,   -22,   -22,   -19,    50,   205,     7,   142,   226,
+     226,   163,   268,   268,   272,   272,   272,   272,   272,   272,
+     275,   275,     2,     2,   -22,   184,   -22,   -22,    50,   -22,
+     247
+  };
+
+  const signed char
+   Parser ::yydefact_[] =
+  {
+       0,     0,     0,     0,     0,    25,    26,     0,    24,    22,
+      23,     0,     2,     3,     5,     6,     0,    11,    16,    17,
+      18,    19,    12,    15,    14,    13,     0,     0,    41,    40,
+       9,     0,     1,     4,    46,     0,     0,     0,     0,     7,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,    20,    27,     0,     0,    47,     0,     0,    21,
+      42,     0,    32,    33,    34,    35,    36,    37,    38,    39,
+      28,    29,    30,    31,    10,     0,    45,    44,     0,     8,
+      43
+  };
+
+  const signed char
+   Parser ::yypgoto_[] =
+  {
+     -22,   -22,   -22,     0,   -22,   -22,   -22,    -1,   -22,   -22,
+     -22,   -22,   -22,   -22,   -22,   -22,   -22,   -22
+  };
+
+  const signed char
+   Parser ::yydefgoto_[] =
+  {
+       0,    11,    12,    13,    14,    15,    31,    16,    17,    18,
+      19,    20,    21,    22,    23,    24,    25,    57
+  };
+
+  const signed char
+   Parser ::yytable_[] =
+  {
+      26,    27,    28,    29,     1,    34,     2,    35,    30,    32,
+      74,    76,    33,     0,     0,     0,     0,    54,     0,     0,
+       0,     0,     3,     0,     0,     4,     5,     6,     7,     0,
+       8,     9,    10,    56,    58,    59,    60,    61,    55,    62,
+      63,    64,    65,    66,    67,    68,    69,    70,    71,    72,
+      73,     0,     0,     1,    75,     2,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     3,     0,     0,     4,     5,     6,    80,     0,     8,
+       9,    10,    34,     0,    35,     0,    36,    37,    38,     0,
+      39,    40,    41,    42,    43,    44,    45,    46,    47,    48,
+      49,    50,    51,    34,    52,    35,     0,    36,    37,    38,
+       0,     0,    40,    41,    42,    43,    44,    45,    46,    47,
+      48,    49,    50,    51,    34,     0,    35,    53,    36,    37,
+      38,     0,     0,    40,    41,    42,    43,    44,    45,    46,
+      47,    48,    49,    50,    51,    34,     0,    35,    77,    36,
+      37,    38,     0,     0,    40,    41,    42,    43,    44,    45,
+      46,    47,    48,    49,    50,    51,    34,     0,    35,     0,
+      36,    37,    38,    78,     0,    40,    41,    42,    43,    44,
+      45,    46,    47,    48,    49,    50,    51,    34,     0,    35,
+       0,    36,    37,    38,     0,    79,    40,    41,    42,    43,
+      44,    45,    46,    47,    48,    49,    50,    51,    34,     0,
+      35,     0,    36,    37,    38,     0,     0,    40,    41,    42,
+      43,    44,    45,    46,    47,    48,    49,    50,    51,    34,
+       0,    35,     0,     0,    37,    38,     0,     0,    40,    41,
+      42,    43,    44,    45,    46,    47,    48,    49,    50,    51,
+      34,     0,    35,     0,     0,     0,    38,     0,     0,    40,
+      41,    42,    43,    44,    45,    46,    47,    48,    49,    50,
+      51,    34,     0,    35,     0,    34,     0,    35,    34,     0,
+      35,     0,    42,    43,    44,    45,    46,    47,    48,    49,
+      50,    51,    48,    49,    50,    51,     0,    50,    51
+  };
+
+  const signed char
+   Parser ::yycheck_[] =
+  {
+       1,     2,     3,     4,     3,     3,     5,     5,    29,     0,
+      29,     4,    12,    -1,    -1,    -1,    -1,     7,    -1,    -1,
+      -1,    -1,    21,    -1,    -1,    24,    25,    26,    27,    -1,
+      29,    30,    31,    34,    35,    36,    37,    38,    28,    40,
+      41,    42,    43,    44,    45,    46,    47,    48,    49,    50,
+      51,    -1,    -1,     3,    55,     5,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    21,    -1,    -1,    24,    25,    26,    78,    -1,    29,
+      30,    31,     3,    -1,     5,    -1,     7,     8,     9,    -1,
+      11,    12,    13,    14,    15,    16,    17,    18,    19,    20,
+      21,    22,    23,     3,     4,     5,    -1,     7,     8,     9,
+      -1,    -1,    12,    13,    14,    15,    16,    17,    18,    19,
+      20,    21,    22,    23,     3,    -1,     5,     6,     7,     8,
+       9,    -1,    -1,    12,    13,    14,    15,    16,    17,    18,
+      19,    20,    21,    22,    23,     3,    -1,     5,     6,     7,
+       8,     9,    -1,    -1,    12,    13,    14,    15,    16,    17,
+      18,    19,    20,    21,    22,    23,     3,    -1,     5,    -1,
+       7,     8,     9,    10,    -1,    12,    13,    14,    15,    16,
+      17,    18,    19,    20,    21,    22,    23,     3,    -1,     5,
+      -1,     7,     8,     9,    -1,    11,    12,    13,    14,    15,
+      16,    17,    18,    19,    20,    21,    22,    23,     3,    -1,
+       5,    -1,     7,     8,     9,    -1,    -1,    12,    13,    14,
+      15,    16,    17,    18,    19,    20,    21,    22,    23,     3,
+      -1,     5,    -1,    -1,     8,     9,    -1,    -1,    12,    13,
+      14,    15,    16,    17,    18,    19,    20,    21,    22,    23,
+       3,    -1,     5,    -1,    -1,    -1,     9,    -1,    -1,    12,
+      13,    14,    15,    16,    17,    18,    19,    20,    21,    22,
+      23,     3,    -1,     5,    -1,     3,    -1,     5,     3,    -1,
+       5,    -1,    14,    15,    16,    17,    18,    19,    20,    21,
+      22,    23,    20,    21,    22,    23,    -1,    22,    23
+  };
+
+  const signed char
+   Parser ::yystos_[] =
+  {
+       0,     3,     5,    21,    24,    25,    26,    27,    29,    30,
+      31,    33,    34,    35,    36,    37,    39,    40,    41,    42,
+      43,    44,    45,    46,    47,    48,    39,    39,    39,    39,
+      29,    38,     0,    35,     3,     5,     7,     8,     9,    11,
+      12,    13,    14,    15,    16,    17,    18,    19,    20,    21,
+      22,    23,     4,     6,     7,    28,    39,    49,    39,    39,
+      39,    39,    39,    39,    39,    39,    39,    39,    39,    39,
+      39,    39,    39,    39,    29,    39,     4,     6,    10,    11,
+      39
+  };
+
+  const signed char
+   Parser ::yyr1_[] =
+  {
+       0,    32,    33,    34,    34,    35,    35,    36,    37,    38,
+      38,    39,    39,    39,    39,    39,    39,    39,    39,    39,
+      39,    39,    40,    40,    40,    40,    40,    40,    41,    41,
+      41,    41,    42,    42,    43,    43,    43,    43,    43,    43,
+      44,    44,    45,    46,    47,    48,    49,    49
+  };
+
+  const signed char
+   Parser ::yyr2_[] =
+  {
+       0,     2,     1,     1,     2,     1,     1,     2,     5,     1,
+       3,     1,     1,     1,     1,     1,     1,     1,     1,     1,
+       3,     3,     1,     1,     1,     1,     1,     3,     3,     3,
+       3,     3,     3,     3,     3,     3,     3,     3,     3,     3,
+       2,     2,     3,     5,     4,     4,     0,     1
+  };
+
+
+#if YYDEBUG
+  // YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
+  // First, the terminals, then, starting at \a YYNTOKENS, nonterminals.
+  const char*
+  const  Parser ::yytname_[] =
+  {
+  "\"end of file\"", "error", "\"invalid token\"", "\"(\"", "\")\"",
+  "\"[\"", "\"]\"", "\",\"", "\"=\"", "\"?\"", "\":\"", "\";\"", "\"&&\"",
+  "\"||\"", "\"==\"", "\"!=\"", "\"<\"", "\">\"", "\"<=\"", "\">=\"",
+  "\"+\"", "\"-\"", "\"*\"", "\"/\"", "\"!\"", "\"true\"", "\"false\"",
+  "\"wait\"", "\"then\"", "IDENTIFIER", "STRING", "NUMBER", "$accept",
+  "program", "statement_list", "statement", "expression_statement",
+  "wait_statement", "identifier_list", "expression", "literal",
+  "arithmetic_expression", "logical_expression", "comparison_expression",
+  "negation_expression", "assignment", "conditional", "array_access",
+  "function_call", "argument_list", YY_NULLPTR
+  };
+#endif
+
+
+#if YYDEBUG
+  const unsigned char
+   Parser ::yyrline_[] =
+  {
+       0,    81,    81,    83,    84,    87,    88,    91,    93,    95,
+      96,    99,   100,   101,   102,   103,   104,   105,   106,   107,
+     108,   109,   112,   113,   114,   115,   116,   117,   120,   121,
+     122,   123,   126,   127,   130,   131,   132,   133,   134,   135,
+     138,   139,   142,   144,   153,   155,   157,   158
+  };
+
+  void
+   Parser ::yy_stack_print_ () const
+  {
+    *yycdebug_ << "Stack now";
+    for (stack_type::const_iterator
+           i = yystack_.begin (),
+           i_end = yystack_.end ();
+         i != i_end; ++i)
+      *yycdebug_ << ' ' << int (i->state);
+    *yycdebug_ << '\n';
+  }
+
+  void
+   Parser ::yy_reduce_print_ (int yyrule) const
+  {
+    int yylno = yyrline_[yyrule];
+    int yynrhs = yyr2_[yyrule];
+    // Print the symbols being reduced, and their result.
+    *yycdebug_ << "Reducing stack by rule " << yyrule - 1
+               << " (line " << yylno << "):\n";
+    // The symbols being reduced.
+    for (int yyi = 0; yyi < yynrhs; yyi++)
+      YY_SYMBOL_PRINT ("   $" << yyi + 1 << " =",
+                       yystack_[(yynrhs) - (yyi + 1)]);
+  }
+#endif // YYDEBUG
+
+
+#line 5 "src/parser.yy"
+} //  dgeval 
+#line 1410 "src/parser.cpp"
+
+#line 162 "src/parser.yy"
+
+
+void dgeval::Parser::error(const location& loc, const std::string& m) {
+    driver.program = std::make_unique<ast::Program>(std::make_unique<ast::StatementList>());
+    driver.program->circular_statements = std::make_unique<ast::StatementList>();
+    driver.program->messages.emplace_back(loc, "Syntax error");
+}
@@ -1,4 +1,5 @@
 #include "printer.hpp"
+#include <map>
 #include <print>
 #include "ast.hpp"
 
@@ -47,7 +48,8 @@ auto escape_string(std::string const& str) -> std::string {
 
 void print_ic(
     const std::string& file_name,
-    const std::vector<Instruction>& instructions
+    const std::vector<Instruction>& instructions,
+    const std::map<std::string_view, int>& peephole_hits
 ) {
     std::ofstream output(file_name);
 
@@ -76,10 +78,16 @@ void print_ic(
             }
         } else if (std::holds_alternative<bool>(value)) {
             std::print(output, "{}", get<bool>(value));
+        } else if (std::holds_alternative<std::vector<uint64_t>>(value)) {
+            std::print(output, "{}", get<std::vector<uint64_t>>(value)[0]);
         }
 
         std::println(output);
     }
+
+    for (auto const& [rule, count] : peephole_hits) {
+        std::println(output, "; peephole {}: {}", rule, count);
+    }
 }
 
 void Printer::visit_program(Program& program) {
@@ -127,6 +135,11 @@ void Printer::visit_program(Program& program) {
     std::print(output, R"(], "executablestatements": )");
     program.statements->accept(*this);
 
+    if (program.dead_statements) {
+        std::print(output, R"(, "deadStatements": )");
+        program.dead_statements->accept(*this);
+    }
+
     std::print(output, R"(, "ic": [)");
     for (auto instruction = instructions.begin();
          instruction != instructions.end();) {
@@ -171,6 +184,14 @@ void Printer::visit_program(Program& program) {
                     );
                 } else if (std::holds_alternative<bool>(value)) {
                     std::print(output, R"(, "value": {})", get<bool>(value));
+                } else if (std::holds_alternative<std::vector<uint64_t>>(
+                               value
+                           )) {
+                    std::print(
+                        output,
+                        R"(, "value": {})",
+                        get<std::vector<uint64_t>>(value)[0]
+                    );
                 }
                 break;
         }
@@ -185,30 +206,88 @@ void Printer::visit_program(Program& program) {
     program.sort_messages();
     std::print(output, R"(], "messages": [)");
     for (auto msg = messages.begin(); msg != messages.end();) {
-        std::print(output, "\"");
-        if (msg->loc.has_value()) {
-            std::print(output, "Line Number {} ", msg->loc->begin.line);
-            std::print("Line Number {} ", msg->loc->begin.line);
+        std::string text = message_text(*msg);
+
+        std::print(output, R"("{}")", text);
+        std::println("{}", text);
+
+        if (++msg != messages.end()) {
+            std::print(output, ", ");
+        }
+    }
+    std::print(output, "]");
+}
+
+Printer::~Printer() {
+    std::print(output, "}}");
+}
+
+void Printer::print_profile(
+    std::vector<lib::ProfileSite> const& sites,
+    std::vector<lib::ProfileCounter> const& counters
+) {
+    std::map<int, std::vector<size_t>> lines;
+
+    for (size_t idx = 0; idx < sites.size(); ++idx) {
+        lines[sites[idx].line].push_back(idx);
+    }
+
+    std::print(output, R"(, "profile": [)");
+    for (auto line = lines.begin(); line != lines.end();) {
+        lib::ProfileCounter statement {};
+        std::vector<size_t> calls;
+
+        for (auto idx : line->second) {
+            if (sites[idx].callee.empty()) {
+                statement = counters[idx];
+            } else {
+                calls.push_back(idx);
+            }
         }
 
         std::print(
             output,
-            R"([{}]: {}.")",
-            SEVERITY_STR[std::to_underlying(msg->severity)],
-            msg->text
+            R"({{"lineNumber": {}, "count": {}, "cycles": {}, "calls": [)",
+            line->first,
+            statement.count,
+            statement.cycles
         );
 
-        std::println(
-            "[{}]: {}.",
-            SEVERITY_STR[std::to_underlying(msg->severity)],
-            msg->text
-        );
+        for (auto call = calls.begin(); call != calls.end();) {
+            std::print(
+                output,
+                R"({{"name": "{}", "count": {}, "cycles": {}}})",
+                sites[*call].callee,
+                counters[*call].count,
+                counters[*call].cycles
+            );
+
+            if (++call != calls.end()) {
+                std::print(output, ", ");
+            }
+        }
 
-        if (++msg != messages.end()) {
+        std::print(output, "]}}");
+
+        if (++line != lines.end()) {
             std::print(output, ", ");
         }
     }
-    std::print(output, "]}}");
+    std::print(output, "]");
+}
+
+auto message_text(Message const& message) -> std::string {
+    std::string text = std::format(
+        "[{}]: {}.",
+        SEVERITY_STR[std::to_underlying(message.severity)],
+        message.text
+    );
+
+    if (message.loc.has_value()) {
+        return std::format("Line Number {} {}", message.loc->begin.line, text);
+    }
+
+    return text;
 }
 
 void Printer::visit_statement_list(StatementList& statements) {
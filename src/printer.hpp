@@ -1,7 +1,10 @@
 #pragma once
 
 #include <fstream>
+#include <map>
+#include <string_view>
 #include "context.hpp"
+#include "lang_runtime.hpp"
 
 namespace dgeval::ast {
 
@@ -11,6 +14,8 @@ class Printer: public Visitor<void> {
   public:
     Printer(const std::string& file_name) : output(file_name + ".json") {}
 
+    ~Printer() override;
+
     void visit_program(Program& program) override;
     void visit_statement_list(StatementList& statements) override;
     void visit_expression_statement(ExpressionStatement& statement) override;
@@ -23,13 +28,19 @@ class Printer: public Visitor<void> {
     void visit_identifier(Identifier& identifier) override;
     void visit_binary_expression(BinaryExpression& binary_expr) override;
     void visit_unary_expression(UnaryExpression& unary_expr) override;
+    void print_profile(
+        std::vector<lib::ProfileSite> const& sites,
+        std::vector<lib::ProfileCounter> const& counters
+    );
 };
 
 void join_strings(std::ofstream& output, std::vector<std::string>& strings);
 auto escape_string(std::string const& str) -> std::string;
+auto message_text(Message const& message) -> std::string;
 void print_ic(
     const std::string& file_name,
-    const std::vector<Instruction>& instructions
+    const std::vector<Instruction>& instructions,
+    const std::map<std::string_view, int>& peephole_hits
 );
 
 } // namespace dgeval::ast
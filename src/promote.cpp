@@ -0,0 +1,127 @@
+#include "promote.hpp"
+#include "optimize.hpp"
+
+namespace dgeval::ast {
+
+Promotion::Promotion(OptimizationFlags flags) :
+    enabled(flags[Optimization::VariablePromotion]) {}
+
+void Promotion::visit_program(Program& program) {
+    if (!enabled) {
+        return;
+    }
+
+    program.statements->accept(*this);
+
+    std::vector<std::pair<std::string, LiveRange>> candidates;
+
+    for (auto const& [symbol, range] : ranges) {
+        auto const& type = program.symbol_table[symbol].type_desc;
+
+        if (range.start != -1 && (type == NUMBER || type == BOOLEAN)) {
+            candidates.emplace_back(symbol, range);
+        }
+    }
+
+    std::ranges::sort(candidates, [](auto const& a, auto const& b) {
+        return a.second.start < b.second.start
+            || (a.second.start == b.second.start && a.first < b.first);
+    });
+
+    std::array<std::pair<std::string, LiveRange>*, PROMOTION_REGISTER_COUNT>
+        active {};
+
+    for (auto& candidate : candidates) {
+        auto& [symbol, range] = candidate;
+        int victim = -1;
+
+        for (int home = 0; home < PROMOTION_REGISTER_COUNT; ++home) {
+            if (active[home] && active[home]->second.end < range.start) {
+                active[home] = nullptr;
+            }
+
+            if (!active[home]) {
+                victim = home;
+                break;
+            }
+
+            if (active[home]->second.uses < range.uses
+                && (victim == -1
+                    || active[home]->second.uses
+                        < active[victim]->second.uses)) {
+                victim = home;
+            }
+        }
+
+        if (victim == -1) {
+            continue;
+        }
+
+        if (active[victim]) {
+            program.symbol_table[active[victim]->first].home = -1;
+        }
+
+        active[victim] = &candidate;
+        program.symbol_table[symbol].home = victim;
+    }
+}
+
+void Promotion::visit_statement_list(StatementList& statements) {
+    for (size_t idx = 0; idx < statements.inner.size(); ++idx) {
+        statement_idx = idx;
+        statements.inner[idx]->accept(*this);
+    }
+}
+
+void Promotion::visit_expression_statement(ExpressionStatement& statement) {
+    statement.expression->accept(*this);
+}
+
+void Promotion::visit_wait_statement(WaitStatement& statement) {
+    statement.expression->accept(*this);
+}
+
+void Promotion::visit_expression(Expression& expression) {}
+
+void Promotion::visit_number(NumberLiteral& number) {}
+
+void Promotion::visit_string(StringLiteral& string) {}
+
+void Promotion::visit_boolean(BooleanLiteral& boolean) {}
+
+void Promotion::visit_array(ArrayLiteral& array) {
+    opcode = Opcode::None;
+    array.items->accept(*this);
+}
+
+void Promotion::visit_identifier(Identifier& identifier) {
+    if (RUNTIME_LIBRARY.contains(identifier.id)) {
+        return;
+    }
+
+    auto& range = ranges[identifier.id];
+
+    if (opcode == Opcode::Assign) {
+        range.start = statement_idx;
+        range.end = std::max(range.end, statement_idx);
+    } else if (opcode != Opcode::Call) {
+        range.end = std::max(range.end, statement_idx);
+        ++range.uses;
+    }
+}
+
+void Promotion::visit_binary_expression(BinaryExpression& binary_expr) {
+    opcode = binary_expr.opcode;
+    binary_expr.left->accept(*this);
+    opcode = Opcode::None;
+    if (binary_expr.right) {
+        binary_expr.right->accept(*this);
+    }
+}
+
+void Promotion::visit_unary_expression(UnaryExpression& unary_expr) {
+    opcode = Opcode::None;
+    unary_expr.left->accept(*this);
+}
+
+} // namespace dgeval::ast
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "context.hpp"
+
+namespace dgeval::ast {
+
+class OptimizationFlags;
+
+inline constexpr int PROMOTION_REGISTER_COUNT = 4;
+
+struct LiveRange {
+    int start {-1};
+    int end {-1};
+    int uses {0};
+};
+
+class Promotion: public Visitor<void> {
+    Opcode opcode;
+    int statement_idx;
+    std::unordered_map<std::string, LiveRange> ranges;
+    bool enabled;
+
+  public:
+    Promotion(OptimizationFlags flags);
+    void visit_program(Program& program) override;
+    void visit_statement_list(StatementList& statements) override;
+    void visit_expression_statement(ExpressionStatement& statement) override;
+    void visit_wait_statement(WaitStatement& statement) override;
+    void visit_expression(Expression& expression) override;
+    void visit_number(NumberLiteral& number) override;
+    void visit_string(StringLiteral& string) override;
+    void visit_boolean(BooleanLiteral& boolean) override;
+    void visit_array(ArrayLiteral& array) override;
+    void visit_identifier(Identifier& identifier) override;
+    void visit_binary_expression(BinaryExpression& binary_expr) override;
+    void visit_unary_expression(UnaryExpression& unary_expr) override;
+};
+
+} // namespace dgeval::ast
@@ -1,30 +1,58 @@
 #include "runtime_library.hpp"
 #include <algorithm>
 #include <cmath>
+#include <numeric>
 #include <print>
 #include <random>
 #include "lang_runtime.hpp"
 
 namespace lib {
 
-auto stddev(ArrayDouble* array) -> double {
-    return array->stddev();
+auto numbers(Array* array) -> std::span<double const> {
+    return {array->items<double>(), static_cast<size_t>(array->length)};
 }
 
-auto mean(ArrayDouble* array) -> double {
-    return array->mean();
+auto stddev(Array* array) -> double {
+    auto items = numbers(array);
+
+    if (items.empty()) {
+        return 0;
+    }
+
+    double sumx = 0;
+    double sumx2 = 0;
+
+    for (auto number : items) {
+        sumx += number;
+        sumx2 += number * number;
+    }
+
+    double mean = sumx / items.size();
+    double variance = sumx2 / items.size() - mean * mean;
+
+    return std::sqrt(variance);
+}
+
+auto mean(Array* array) -> double {
+    auto items = numbers(array);
+
+    if (items.empty()) {
+        return 0;
+    }
+
+    return std::reduce(items.begin(), items.end()) / items.size();
 }
 
-auto count(ArrayDouble* array) -> double {
-    return array->count();
+auto count(Array* array) -> double {
+    return array->length;
 }
 
-auto min(ArrayDouble* array) -> double {
-    return array->min();
+auto min(Array* array) -> double {
+    return *std::ranges::min_element(numbers(array));
 }
 
-auto max(ArrayDouble* array) -> double {
-    return array->max();
+auto max(Array* array) -> double {
+    return *std::ranges::max_element(numbers(array));
 }
 
 auto print(std::string& str) -> double {
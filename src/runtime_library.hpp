@@ -1,17 +1,19 @@
 #pragma once
 
+#include <span>
 #include <string>
 
 namespace lib {
 
-class ArrayDouble;
+class Array;
 class Runtime;
 
-auto stddev(ArrayDouble* array) -> double;
-auto mean(ArrayDouble* array) -> double;
-auto count(ArrayDouble* array) -> double;
-auto min(ArrayDouble* array) -> double;
-auto max(ArrayDouble* array) -> double;
+auto numbers(Array* array) -> std::span<double const>;
+auto stddev(Array* array) -> double;
+auto mean(Array* array) -> double;
+auto count(Array* array) -> double;
+auto min(Array* array) -> double;
+auto max(Array* array) -> double;
 auto sin(double number) -> double;
 auto cos(double number) -> double;
 auto tan(double number) -> double;
@@ -0,0 +1,576 @@
+#include "value_graph.hpp"
+#include <algorithm>
+#include <format>
+#include <unordered_map>
+#include "context.hpp"
+#include "optimize.hpp"
+
+namespace dgeval::ast {
+
+auto Value::stack_operands() const -> std::span<int const> {
+    switch (instruction.opcode) {
+        case Opcode::Identifier:
+        case Opcode::Jump:
+            return {};
+        case Opcode::Phi:
+            if (variable != -1) {
+                return {};
+            }
+            return operands;
+        default:
+            return operands;
+    }
+}
+
+auto Value::temporary_load() const -> Instruction {
+    Instruction load(Opcode::Identifier, temporary, result_type());
+    load.value = std::format("%{}", temporary);
+    load.line_number = instruction.line_number;
+    return load;
+}
+
+auto Value::temporary_store() const -> Instruction {
+    Instruction store(Opcode::Assign, temporary, result_type());
+    store.value = std::format("%{}", temporary);
+    store.line_number = instruction.line_number;
+    return store;
+}
+
+GraphBuilder::GraphBuilder(OptimizationFlags flags) :
+    skip_dead_statements(flags[Optimization::DeadStatement]),
+    skip_dead_parts(flags[Optimization::DeadExpressionPart]) {}
+
+void GraphBuilder::visit_program(Program& program) {
+    definitions.assign(program.symbol_table.size(), -1);
+    variables.assign(program.symbol_table.size(), {Opcode::Phi, 0});
+
+    for (auto const& [symbol, descriptor] : program.symbol_table) {
+        auto& variable = variables[descriptor.idx];
+        variable.parameter = descriptor.idx;
+        variable.type = descriptor.type_desc;
+        variable.value = symbol;
+    }
+
+    open_block({}, -1);
+    program.statements->accept(*this);
+    graph.blocks[current].end = static_cast<int>(graph.values.size());
+    program.graph = std::move(graph);
+}
+
+void GraphBuilder::visit_statement_list(StatementList& statements) {
+    for (auto& statement : statements.inner) {
+        if (!skip_dead_statements || statement->expression->is_effective()) {
+            line_number = statement->line_number;
+            statement->accept(*this);
+            graph.values[result].pinned |= !skip_dead_statements;
+        }
+    }
+
+    line_number = 0;
+    Instruction cleanup(Opcode::CallLRT, 8);
+    cleanup.value = 0.0;
+    add(cleanup);
+}
+
+void GraphBuilder::visit_expression_statement(ExpressionStatement& statement) {
+    result = evaluate(*statement.expression);
+}
+
+void GraphBuilder::visit_wait_statement(WaitStatement& statement) {
+    result = evaluate(*statement.expression);
+}
+
+void GraphBuilder::visit_expression(Expression& expression) {}
+
+void GraphBuilder::visit_number(NumberLiteral& number) {
+    Instruction instruction(number.type_desc);
+    instruction.value = number.value;
+    result = add(instruction);
+}
+
+void GraphBuilder::visit_string(StringLiteral& string) {
+    Instruction instruction(string);
+    instruction.value = string.value;
+    result = add(instruction);
+}
+
+void GraphBuilder::visit_boolean(BooleanLiteral& boolean) {
+    Instruction instruction(boolean.type_desc);
+    instruction.value = boolean.value;
+    result = add(instruction);
+}
+
+void GraphBuilder::visit_array(ArrayLiteral& array) {
+    if (array.idNdx == 9) {
+        Instruction instruction(array);
+        instruction.value = constant_array_data(array);
+        result = add(instruction);
+        return;
+    }
+
+    std::vector<int> items;
+    collect(*array.items, items);
+
+    Instruction instruction(array);
+    instruction.value = static_cast<double>(array.item_count);
+    result = add(instruction, std::move(items));
+}
+
+void GraphBuilder::visit_identifier(Identifier& identifier) {
+    Instruction instruction(
+        identifier.opcode,
+        identifier.idNdx,
+        identifier.type_desc
+    );
+    instruction.value = identifier.id;
+
+    int definition = definitions[identifier.idNdx];
+    result = add(
+        instruction,
+        definition != -1 ? std::vector {definition} : std::vector<int> {}
+    );
+    graph.values[result].variable = identifier.idNdx;
+}
+
+void GraphBuilder::visit_binary_expression(BinaryExpression& binary_expr) {
+    auto& left = binary_expr.left;
+    auto& right = binary_expr.right;
+    Instruction instruction(
+        binary_expr.opcode,
+        binary_expr.idNdx,
+        binary_expr.type_desc
+    );
+
+    switch (binary_expr.opcode) {
+        case Opcode::Comma: {
+            int first = evaluate(*left);
+            evaluate(*right);
+            result = first;
+        } break;
+        case Opcode::Conditional:
+            conditional(binary_expr);
+            break;
+        case Opcode::Assign: {
+            auto const& id = dynamic_cast<Identifier*>(left.get())->id;
+            instruction.value = id;
+            result = add(instruction, {evaluate(*right)});
+            graph.values[result].variable = binary_expr.idNdx;
+            define(binary_expr.idNdx, result);
+        } break;
+        case Opcode::Call: {
+            auto const& id = dynamic_cast<Identifier*>(left.get())->id;
+            std::vector<int> arguments;
+            if (right) {
+                collect(*right, arguments);
+            }
+
+            instruction.value = id;
+            instruction.parameter = RUNTIME_LIBRARY.at(id).parameter_count;
+            result = add(instruction, std::move(arguments));
+        } break;
+        default: {
+            int lhs = evaluate(*left);
+            int rhs = evaluate(*right);
+
+            specialize(instruction, binary_expr, left->type_desc);
+            result = add(instruction, {lhs, rhs});
+        } break;
+    }
+}
+
+void GraphBuilder::visit_unary_expression(UnaryExpression& unary_expr) {
+    int operand = evaluate(*unary_expr.left);
+
+    Instruction instruction(
+        unary_expr.opcode,
+        unary_expr.idNdx,
+        unary_expr.type_desc
+    );
+
+    specialize(instruction, unary_expr, unary_expr.left->type_desc);
+    result = add(instruction, {operand});
+}
+
+auto GraphBuilder::evaluate(Expression& expression) -> int {
+    expression.accept(*this);
+    return result;
+}
+
+void GraphBuilder::collect(Expression& expression, std::vector<int>& items) {
+    if (expression.opcode == Opcode::Comma) {
+        auto& comma = dynamic_cast<BinaryExpression&>(expression);
+        collect(*comma.left, items);
+        items.push_back(evaluate(*comma.right));
+    } else {
+        items.push_back(evaluate(expression));
+    }
+}
+
+void GraphBuilder::conditional(BinaryExpression& binary_expr) {
+    auto& alt = dynamic_cast<BinaryExpression&>(*binary_expr.right);
+    int condition = evaluate(*binary_expr.left);
+    int entry = current;
+    int branch = add({Opcode::JumpFalse, 0, NUMBER}, {condition});
+    size_t mark = assignments.size();
+
+    open_block({entry}, entry);
+    int true_value = evaluate(*alt.left);
+    int jump = add({Opcode::Jump, 0, NUMBER});
+    int true_exit = current;
+    auto true_definitions = arm_definitions(mark);
+    undo_definitions(mark);
+
+    graph.values[branch].instruction.parameter = open_block({entry}, entry);
+    int false_value = evaluate(*alt.right);
+    int false_exit = current;
+    auto false_definitions = arm_definitions(mark);
+    undo_definitions(mark);
+
+    graph.values[jump].instruction.parameter =
+        open_block({true_exit, false_exit}, entry);
+
+    std::vector<int> merged_variables;
+    std::unordered_map<int, std::pair<int, int>> merged;
+
+    for (auto [variable, definition] : true_definitions) {
+        merged[variable] = {definition, definitions[variable]};
+        merged_variables.push_back(variable);
+    }
+
+    for (auto [variable, definition] : false_definitions) {
+        auto [it, inserted] =
+            merged.try_emplace(variable, definitions[variable], definition);
+
+        if (inserted) {
+            merged_variables.push_back(variable);
+        } else {
+            it->second.second = definition;
+        }
+    }
+
+    for (int variable : merged_variables) {
+        auto [true_definition, false_definition] = merged[variable];
+        int phi = add(variables[variable], {true_definition, false_definition});
+        graph.values[phi].variable = variable;
+        define(variable, phi);
+    }
+
+    result = add(
+        {Opcode::Phi, 0, binary_expr.type_desc},
+        {true_value, false_value}
+    );
+}
+
+auto GraphBuilder::add(Instruction instruction, std::vector<int> operands)
+    -> int {
+    int id = static_cast<int>(graph.values.size());
+    instruction.line_number = line_number;
+
+    auto& value = graph.values.emplace_back(std::move(instruction), current);
+    value.operands = std::move(operands);
+
+    switch (value.instruction.opcode) {
+        case Opcode::Assign:
+        case Opcode::Call:
+            value.pinned = true;
+            break;
+        case Opcode::CallLRT:
+            value.pinned = value.instruction.parameter == 8;
+            break;
+        default:
+            value.pinned = !skip_dead_parts;
+            break;
+    }
+
+    return id;
+}
+
+auto GraphBuilder::open_block(std::vector<int> predecessors, int dominator)
+    -> int {
+    int begin = static_cast<int>(graph.values.size());
+
+    if (!graph.blocks.empty()) {
+        graph.blocks[current].end = begin;
+    }
+
+    current = static_cast<int>(graph.blocks.size());
+    graph.blocks.push_back({begin, begin, dominator, std::move(predecessors)});
+
+    return current;
+}
+
+void GraphBuilder::define(int variable, int value) {
+    assignments.emplace_back(variable, definitions[variable]);
+    definitions[variable] = value;
+}
+
+auto GraphBuilder::arm_definitions(size_t mark) const
+    -> std::vector<std::pair<int, int>> {
+    std::vector<std::pair<int, int>> arm;
+    std::unordered_map<int, bool> seen;
+
+    for (size_t idx = assignments.size(); idx > mark; --idx) {
+        int variable = assignments[idx - 1].first;
+
+        if (!seen[variable]) {
+            seen[variable] = true;
+            arm.emplace_back(variable, definitions[variable]);
+        }
+    }
+
+    return arm;
+}
+
+void GraphBuilder::undo_definitions(size_t mark) {
+    while (assignments.size() > mark) {
+        auto [variable, previous] = assignments.back();
+        definitions[variable] = previous;
+        assignments.pop_back();
+    }
+}
+
+StackLowering::StackLowering(OptimizationFlags flags) :
+    fuse_branches(flags[Optimization::BranchFusion]) {}
+
+void StackLowering::run(Program& program) {
+    auto& graph = program.graph;
+    mark_live(graph);
+
+    std::vector<int> block_offsets(graph.blocks.size());
+
+    for (size_t block = 0; block < graph.blocks.size(); ++block) {
+        block_offsets[block] = static_cast<int>(instructions.size());
+        block_start = instructions.size();
+
+        for (int id = graph.blocks[block].begin; id < graph.blocks[block].end;
+             ++id) {
+            auto const& value = graph.values[id];
+
+            if (!value.live) {
+                continue;
+            }
+
+            if (value.instruction.opcode == Opcode::JumpFalse) {
+                emit_branch(value, graph);
+            } else {
+                emit(value, id);
+            }
+        }
+    }
+
+    for (auto [idx, block] : jumps) {
+        instructions[idx].parameter = block_offsets[block];
+    }
+
+    program.instructions = std::move(instructions);
+}
+
+void StackLowering::mark_live(ValueGraph& graph) const {
+    auto& values = graph.values;
+    std::vector<int> regions;
+
+    for (int id = static_cast<int>(values.size()) - 1; id >= 0; --id) {
+        auto& value = values[id];
+
+        if (value.is_phi() && value.variable == -1) {
+            regions.push_back(0);
+        }
+
+        bool live = value.pinned || value.uses > 0 || value.live;
+
+        if (value.instruction.opcode == Opcode::JumpFalse) {
+            live = regions.back() > 0;
+            regions.pop_back();
+
+            if (live) {
+                int false_block = value.instruction.parameter;
+                values[graph.blocks[false_block].begin - 1].live = true;
+            }
+        } else if (value.instruction.opcode == Opcode::Jump) {
+            continue;
+        }
+
+        if (!live) {
+            continue;
+        }
+
+        value.live = true;
+
+        for (int operand : value.stack_operands()) {
+            ++values[operand].uses;
+        }
+
+        if (value.instruction.opcode == Opcode::Identifier
+            && !value.operands.empty()) {
+            values[value.operands[0]].live = true;
+        }
+
+        if (!regions.empty()) {
+            ++regions.back();
+        }
+    }
+}
+
+void StackLowering::emit(Value const& value, int id) {
+    if (value.is_phi()) {
+        if (value.variable == -1 && value.uses == 0) {
+            push_pop(value.instruction.line_number);
+        }
+        return;
+    }
+
+    if (value.instruction.opcode == Opcode::Jump) {
+        jumps.emplace_back(instructions.size(), value.instruction.parameter);
+    }
+
+    instructions.push_back(value.instruction);
+    producers.push_back(id);
+
+    if (value.temporary != -1) {
+        instructions.push_back(value.temporary_store());
+        producers.push_back(-1);
+    }
+
+    if (value.uses == 0 && value.has_result()) {
+        push_pop(value.instruction.line_number);
+    }
+}
+
+void StackLowering::emit_branch(Value const& value, ValueGraph const& graph) {
+    // The condition was emitted last in the block. Its instructions are taken
+    // back and emitted again with the jumps fused into them.
+    std::vector code(instructions.begin() + block_start, instructions.end());
+    std::vector sources(producers.begin() + block_start, producers.end());
+    std::vector<size_t> exits;
+
+    instructions.erase(instructions.begin() + block_start, instructions.end());
+    producers.erase(producers.begin() + block_start, producers.end());
+    branch(code, sources, value.operands[0], value.instruction, exits, graph);
+
+    for (size_t idx : exits) {
+        jumps.emplace_back(idx, value.instruction.parameter);
+    }
+}
+
+// Emits `code`, which computes `condition` last, followed by `jump`. A
+// comparison or Not is fused into the jump, and And and Or short-circuit
+// when their right operand can be skipped, like LinearIR::fuse_branch.
+void StackLowering::branch(
+    std::span<Instruction const> code,
+    std::span<int const> sources,
+    int condition,
+    Instruction jump,
+    std::vector<size_t>& exits,
+    ValueGraph const& graph
+) {
+    auto const& value = graph.values[condition];
+    auto const& source = value.instruction;
+    bool jump_if = jump.opcode == Opcode::JumpTrue;
+    bool fusible = fuse_branches && !sources.empty()
+        && sources.back() == condition && value.uses == 1;
+    // Everything before the condition's own instruction.
+    auto operand_code = code.first(code.size() - (fusible ? 1 : 0));
+    auto operand_sources = sources.first(operand_code.size());
+
+    Instruction negated = jump;
+    negated.opcode = jump_if ? Opcode::JumpFalse : Opcode::JumpTrue;
+
+    if (fusible && source.opcode == Opcode::Not) {
+        branch(
+            operand_code,
+            operand_sources,
+            value.operands[0],
+            negated,
+            exits,
+            graph
+        );
+        return;
+    }
+
+    bool logical = source.opcode == Opcode::And || source.opcode == Opcode::Or;
+    auto left = logical
+        ? std::ranges::find(operand_sources, value.operands[0])
+        : operand_sources.end();
+
+    if (fusible && left != operand_sources.end()) {
+        size_t middle = left - operand_sources.begin() + 1;
+        auto left_code = operand_code.first(middle);
+        auto left_sources = operand_sources.first(middle);
+        auto right_code = operand_code.subspan(middle);
+        auto right_sources = operand_sources.subspan(middle);
+
+        if (can_skip(right_code, right_sources, graph)) {
+            int right = value.operands[1];
+
+            if ((source.opcode == Opcode::And) != jump_if) {
+                branch(left_code, left_sources, *left, jump, exits, graph);
+                branch(right_code, right_sources, right, jump, exits, graph);
+            } else {
+                std::vector<size_t> skip;
+                branch(left_code, left_sources, *left, negated, skip, graph);
+                branch(right_code, right_sources, right, jump, exits, graph);
+
+                for (size_t idx : skip) {
+                    instructions[idx].parameter =
+                        static_cast<int>(instructions.size());
+                }
+            }
+
+            return;
+        }
+    }
+
+    if (fusible && source.is_comparison()) {
+        jump.opcode = fused_jump(source.opcode, jump_if);
+        jump.type = source.type;
+        code = operand_code;
+        sources = operand_sources;
+    }
+
+    instructions.insert(instructions.end(), code.begin(), code.end());
+    producers.insert(producers.end(), sources.begin(), sources.end());
+    exits.push_back(instructions.size());
+    instructions.push_back(jump);
+    producers.push_back(-1);
+}
+
+void StackLowering::push_pop(int line_number) {
+    if (instructions.size() > block_start
+        && instructions.back().opcode == Opcode::Pop) {
+        ++instructions.back().parameter;
+        return;
+    }
+
+    instructions.emplace_back(Opcode::Pop, 1);
+    instructions.back().line_number = line_number;
+    producers.push_back(-1);
+}
+
+// Whether `code` can be jumped over: it must have no effect, must not throw
+// and must not leave a value behind for later instructions.
+auto can_skip(
+    std::span<Instruction const> code,
+    std::span<int const> sources,
+    ValueGraph const& graph
+) -> bool {
+    for (size_t idx = 0; idx < code.size(); ++idx) {
+        if (sources[idx] == -1 || graph.values[sources[idx]].temporary != -1) {
+            return false;
+        }
+
+        // Element access can throw and an append mutates its array.
+        switch (code[idx].opcode) {
+            case Opcode::Assign:
+            case Opcode::Call:
+            case Opcode::ArrayElement:
+            case Opcode::Append:
+                return false;
+            default:
+                break;
+        }
+    }
+
+    return true;
+}
+
+} // namespace dgeval::ast
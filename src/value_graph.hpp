@@ -0,0 +1,128 @@
+#pragma once
+
+#include <span>
+#include "linear_ir.hpp"
+
+namespace dgeval::ast {
+
+class OptimizationFlags;
+class Program;
+
+class Value {
+  public:
+    Value(Instruction instruction, int block) :
+        instruction(std::move(instruction)),
+        block(block) {}
+
+    [[nodiscard]] auto is_phi() const -> bool {
+        return instruction.opcode == Opcode::Phi;
+    }
+
+    [[nodiscard]] auto has_result() const -> bool {
+        return instruction.opcode != Opcode::Jump
+            && instruction.opcode != Opcode::JumpFalse
+            && (instruction.opcode != Opcode::CallLRT
+                || instruction.parameter != 8);
+    }
+
+    [[nodiscard]] auto result_type() const -> TypeDescriptor {
+        if (instruction.is_comparison()) {
+            return BOOLEAN;
+        }
+
+        return instruction.type;
+    }
+
+    [[nodiscard]] auto stack_operands() const -> std::span<int const>;
+    [[nodiscard]] auto temporary_load() const -> Instruction;
+    [[nodiscard]] auto temporary_store() const -> Instruction;
+
+    Instruction instruction;
+    std::vector<int> operands;
+    int block;
+    int variable {-1};
+    int temporary {-1};
+    int uses {};
+    bool pinned {false};
+    bool live {false};
+};
+
+struct BasicBlock {
+    int begin {};
+    int end {};
+    int dominator {-1};
+    std::vector<int> predecessors;
+};
+
+class ValueGraph {
+  public:
+    std::vector<Value> values;
+    std::vector<BasicBlock> blocks;
+};
+
+class GraphBuilder: public Visitor<void> {
+  public:
+    GraphBuilder(OptimizationFlags flags);
+    void visit_program(Program& program) override;
+    void visit_statement_list(StatementList& statements) override;
+    void visit_expression_statement(ExpressionStatement& statement) override;
+    void visit_wait_statement(WaitStatement& statement) override;
+    void visit_expression(Expression& expression) override;
+    void visit_number(NumberLiteral& number) override;
+    void visit_string(StringLiteral& string) override;
+    void visit_boolean(BooleanLiteral& boolean) override;
+    void visit_array(ArrayLiteral& array) override;
+    void visit_identifier(Identifier& identifier) override;
+    void visit_binary_expression(BinaryExpression& binary_expr) override;
+    void visit_unary_expression(UnaryExpression& unary_expr) override;
+    auto evaluate(Expression& expression) -> int;
+    void collect(Expression& expression, std::vector<int>& items);
+    void conditional(BinaryExpression& binary_expr);
+    auto add(Instruction instruction, std::vector<int> operands = {}) -> int;
+    auto open_block(std::vector<int> predecessors, int dominator) -> int;
+    void define(int variable, int value);
+    auto arm_definitions(size_t mark) const -> std::vector<std::pair<int, int>>;
+    void undo_definitions(size_t mark);
+
+    ValueGraph graph;
+    std::vector<int> definitions;
+    std::vector<std::pair<int, int>> assignments;
+    std::vector<Instruction> variables;
+    int current {};
+    int line_number {};
+    int result {-1};
+    bool skip_dead_statements {true};
+    bool skip_dead_parts {true};
+};
+
+class StackLowering {
+  public:
+    StackLowering(OptimizationFlags flags);
+    void run(Program& program);
+    void mark_live(ValueGraph& graph) const;
+    void emit(Value const& value, int id);
+    void emit_branch(Value const& value, ValueGraph const& graph);
+    void branch(
+        std::span<Instruction const> code,
+        std::span<int const> sources,
+        int condition,
+        Instruction jump,
+        std::vector<size_t>& exits,
+        ValueGraph const& graph
+    );
+    void push_pop(int line_number);
+
+    std::vector<Instruction> instructions;
+    std::vector<int> producers;
+    std::vector<std::pair<size_t, int>> jumps;
+    size_t block_start {};
+    bool fuse_branches {true};
+};
+
+auto can_skip(
+    std::span<Instruction const> code,
+    std::span<int const> sources,
+    ValueGraph const& graph
+) -> bool;
+
+} // namespace dgeval::ast
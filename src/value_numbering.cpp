@@ -0,0 +1,215 @@
+#include "value_numbering.hpp"
+#include <bit>
+#include <ranges>
+
+namespace dgeval::ast {
+
+auto ValueKeyHash::operator()(ValueKey const& key) const -> size_t {
+    size_t hash = std::hash<decltype(key.value)>()(key.value);
+
+    auto combine = [&](size_t value) {
+        hash ^= value + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+    };
+
+    combine(std::to_underlying(key.opcode));
+    combine(key.parameter);
+    combine(std::to_underlying(key.type.type));
+    combine(key.type.dimension);
+    combine(key.epoch);
+
+    for (int operand : key.operands) {
+        combine(operand);
+    }
+
+    return hash;
+}
+
+void ValueNumbering::run(Program& program) {
+    graph = &program.graph;
+    auto& values = graph->values;
+    numbers.assign(values.size(), -1);
+
+    for (int id = 0; id < static_cast<int>(values.size()); ++id) {
+        auto& value = values[id];
+        int number = number_of(value, id);
+        numbers[id] = number;
+
+        if (value.instruction.opcode == Opcode::Assign) {
+            leaders[number].push_back(id);
+            continue;
+        }
+
+        if (!is_pure(value.instruction) || value.instruction.is_literal()
+            || value.instruction.opcode == Opcode::Identifier) {
+            continue;
+        }
+
+        if (int leader = find_leader(number, value); leader != -1) {
+            reuse(program, value, leader);
+        } else {
+            leaders[number].push_back(id);
+        }
+    }
+}
+
+auto ValueNumbering::number_of(Value const& value, int id) -> int {
+    auto const& instruction = value.instruction;
+
+    switch (instruction.opcode) {
+        case Opcode::Identifier:
+            if (!value.operands.empty()) {
+                return numbers[value.operands[0]];
+            }
+            break;
+        case Opcode::Assign:
+            return numbers[value.operands[0]];
+        case Opcode::Phi:
+        case Opcode::Jump:
+        case Opcode::JumpFalse:
+            return id;
+        default:
+            if (!is_pure(instruction)) {
+                if (instruction.opcode == Opcode::Append) {
+                    ++epoch;
+                }
+                return id;
+            }
+            break;
+    }
+
+    return table.try_emplace(key_of(value), id).first->second;
+}
+
+auto ValueNumbering::key_of(Value const& value) const -> ValueKey {
+    auto const& instruction = value.instruction;
+    ValueKey key {
+        .opcode = instruction.opcode,
+        .parameter = instruction.parameter,
+        .type = instruction.type,
+        .epoch = reads_memory(instruction) ? epoch : 0,
+    };
+
+    std::visit(
+        [&](auto const& constant) {
+            using T = std::decay_t<decltype(constant)>;
+            if constexpr (std::is_same_v<T, double>) {
+                key.value = std::bit_cast<uint64_t>(constant);
+            } else if constexpr (std::is_same_v<T, std::vector<uint64_t>>) {
+                // Constant arrays are never numbered.
+            } else {
+                key.value = constant;
+            }
+        },
+        instruction.value
+    );
+
+    for (int operand : value.stack_operands()) {
+        key.operands.push_back(numbers[operand]);
+    }
+
+    return key;
+}
+
+auto ValueNumbering::find_leader(int number, Value const& value) const
+    -> int {
+    auto it = leaders.find(number);
+    if (it == leaders.end()) {
+        return -1;
+    }
+
+    int leader = -1;
+
+    for (int candidate : it->second | std::views::reverse) {
+        auto const& source = graph->values[candidate];
+
+        if (!dominates(source.block, value.block)) {
+            continue;
+        }
+
+        if (source.instruction.opcode == Opcode::Assign) {
+            return candidate;
+        }
+
+        leader = candidate;
+    }
+
+    return leader;
+}
+
+void ValueNumbering::reuse(Program& program, Value& value, int leader) {
+    auto& source = graph->values[leader];
+    int line_number = value.instruction.line_number;
+
+    auto const* id = std::get_if<std::string>(&source.instruction.value);
+
+    // Promotion sized live ranges from the uses in the AST, so the register
+    // of a promoted variable may hold another variable by now. Those are
+    // reloaded from a temporary instead.
+    bool in_frame = source.instruction.opcode == Opcode::Assign
+        && program.symbol_table.at(*id).home == -1;
+
+    if (in_frame) {
+        Instruction load(
+            Opcode::Identifier,
+            source.variable,
+            source.instruction.type
+        );
+        load.value = source.instruction.value;
+        value.instruction = load;
+        value.variable = source.variable;
+    } else {
+        if (source.temporary == -1) {
+            source.temporary = static_cast<int>(program.variable_count());
+            ++program.temporary_count;
+        }
+
+        value.instruction = source.temporary_load();
+        value.variable = source.temporary;
+    }
+
+    value.instruction.line_number = line_number;
+    value.operands = {leader};
+}
+
+auto ValueNumbering::dominates(int block, int other) const -> bool {
+    while (other != -1 && other != block) {
+        other = graph->blocks[other].dominator;
+    }
+
+    return other == block;
+}
+
+auto reads_memory(Instruction const& instruction) -> bool {
+    switch (instruction.opcode) {
+        case Opcode::Call:
+            return std::ranges::any_of(
+                RUNTIME_LIBRARY.at(get<std::string>(instruction.value))
+                    .parameters,
+                [](TypeDescriptor type) { return type.is_array(); }
+            );
+        case Opcode::ArrayElement:
+        case Opcode::CompareArray:
+            return true;
+        default:
+            return false;
+    }
+}
+
+auto is_pure(Instruction const& instruction) -> bool {
+    switch (instruction.opcode) {
+        case Opcode::Assign:
+        case Opcode::Jump:
+        case Opcode::JumpFalse:
+        case Opcode::Phi:
+        case Opcode::Append:
+            return false;
+        case Opcode::Call:
+            return RUNTIME_LIBRARY.at(get<std::string>(instruction.value)).pure;
+        case Opcode::CallLRT:
+            return instruction.parameter == 3;
+        default:
+            return true;
+    }
+}
+
+} // namespace dgeval::ast
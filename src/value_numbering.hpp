@@ -0,0 +1,42 @@
+#pragma once
+
+#include <unordered_map>
+#include "context.hpp"
+
+namespace dgeval::ast {
+
+struct ValueKey {
+    auto operator==(ValueKey const& other) const -> bool = default;
+
+    Opcode opcode;
+    int parameter;
+    TypeDescriptor type;
+    std::variant<std::monostate, uint64_t, std::string, bool> value;
+    std::vector<int> operands;
+    int epoch;
+};
+
+struct ValueKeyHash {
+    auto operator()(ValueKey const& key) const -> size_t;
+};
+
+class ValueNumbering {
+  public:
+    void run(Program& program);
+    auto number_of(Value const& value, int id) -> int;
+    auto key_of(Value const& value) const -> ValueKey;
+    auto find_leader(int number, Value const& value) const -> int;
+    void reuse(Program& program, Value& value, int leader);
+    [[nodiscard]] auto dominates(int block, int other) const -> bool;
+
+    ValueGraph* graph {};
+    std::vector<int> numbers;
+    std::unordered_map<ValueKey, int, ValueKeyHash> table;
+    std::unordered_map<int, std::vector<int>> leaders;
+    int epoch {};
+};
+
+auto reads_memory(Instruction const& instruction) -> bool;
+auto is_pure(Instruction const& instruction) -> bool;
+
+} // namespace dgeval::ast